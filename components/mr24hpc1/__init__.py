@@ -1,10 +1,45 @@
+import zlib
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart
-from esphome.const import CONF_ID
+from esphome import automation
+from esphome.components import time, uart, web_server_base
+from esphome.components.web_server_base import CONF_WEB_SERVER_BASE_ID
+from esphome.const import (
+    CONF_DURATION,
+    CONF_ID,
+    CONF_PATH,
+    CONF_PORT,
+    CONF_TIME_ID,
+    CONF_TRIGGER_ID,
+)
 from esphome.automation import maybe_simple_id
+from esphome.core import CORE
 
+DOMAIN = "mr24hpc1"
 DEPENDENCIES = ["uart"]
+CONF_STREAM = "stream"
+CONF_WEB = "web"
+
+
+# The frame splitter, checksum and frame builder are shared with the other Seeed mmWave radars.
+# The socket component is only pulled in when one of the radars streams frames to a collector,
+# the web server base when one of them serves the live view.
+def AUTO_LOAD():
+    if CORE.raw_config is None:
+        return ["seeed_radar", "socket", "web_server_base"]
+    configs = CORE.raw_config.get(DOMAIN) or []
+    if isinstance(configs, dict):
+        configs = [configs]
+    configs = [conf for conf in configs if isinstance(conf, dict)]
+    components = ["seeed_radar"]
+    if any(CONF_STREAM in conf for conf in configs):
+        components.append("socket")
+    if any(CONF_WEB in conf for conf in configs):
+        components.append("web_server_base")
+    return components
+
+
 # is the code owner of the relevant code base
 CODEOWNERS = ["@limengdu"]
 # The current component or platform can be configured or defined multiple times in the same configuration file.
@@ -17,13 +52,96 @@ mr24hpc1_ns = cg.esphome_ns.namespace("mr24hpc1")
 mr24hpc1Component = mr24hpc1_ns.class_(
     "mr24hpc1Component", cg.PollingComponent, uart.UARTDevice
 )
+CalibrateAction = mr24hpc1_ns.class_("CalibrateAction", automation.Action)
+DumpEventLogAction = mr24hpc1_ns.class_("DumpEventLogAction", automation.Action)
+EventLogRecordTrigger = mr24hpc1_ns.class_(
+    "EventLogRecordTrigger",
+    automation.Trigger.template(cg.uint32, cg.std_string, cg.uint8, cg.bool_),
+)
+
+# The radar is polled once per update interval, a quiet radar sends nothing but the heartbeat reply then
+UPDATE_INTERVAL_MS = 8000  # PollingComponent(8000) in mr24hpc1.h
 
 CONF_MR24HPC1_ID = "mr24hpc1_id"
+CONF_MIN_WRITE_INTERVAL = "min_write_interval"
+CONF_STALL_INTERVALS = "stall_intervals"
+CONF_RX_POLL_INTERVAL = "rx_poll_interval"
+CONF_HOST = "host"
+CONF_PROTOCOL = "protocol"
+CONF_BATCH_SIZE = "batch_size"
+CONF_FLUSH_INTERVAL = "flush_interval"
+CONF_UNDERLYING_OPEN_MODE = "underlying_open_mode"
+CONF_UNMANNED_HOLD_TIME = "unmanned_hold_time"
+CONF_MIN_TOGGLE_INTERVAL = "min_toggle_interval"
+CONF_MARGIN = "margin"
+CONF_EVENT_LOG = "event_log"
+CONF_PAGES = "pages"
+CONF_ON_RECORD = "on_record"
+
+# Raw underlying open frames sent to a collector in a compact binary format, see frame_stream.h
+STREAM_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_HOST): cv.ipv4address,      # IP address of the collector, host names are not resolved
+        cv.Required(CONF_PORT): cv.port,
+        cv.Optional(CONF_PROTOCOL, default="udp"): cv.one_of("udp", "tcp", lower=True),
+        cv.Optional(CONF_BATCH_SIZE, default=16): cv.int_range(min=1, max=32),
+        cv.Optional(CONF_FLUSH_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+    }
+)
+
+# Presence, motion status and keep away transitions kept in flash, see event_log.h.
+# Without a time source the records carry seconds since boot. mr24hpc1.dump_event_log replays the
+# records to the log and to on_record, with timestamp, event, value and uptime.
+EVENT_LOG_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_PAGES, default=8): cv.int_range(min=2, max=32),   # 16 records per page
+        cv.Optional(CONF_FLUSH_INTERVAL, default="10min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_TIME_ID): cv.use_id(time.RealTimeClock),
+        cv.Optional(CONF_ON_RECORD): automation.validate_automation(
+            {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(EventLogRecordTrigger)}
+        ),
+    }
+)
+
+# Live chart of the underlying open stream on the device web server, see frame_web.h
+WEB_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_WEB_SERVER_BASE_ID): cv.use_id(web_server_base.WebServerBase),
+        cv.Optional(CONF_PATH, default="/mr24hpc1"): cv.All(cv.string_strict, cv.Length(min=2)),
+    }
+)
 
 # A base schema is created
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(mr24hpc1Component),
+        # Minimum spacing between two setting writes to the radar, later writes to the same setting replace queued ones
+        cv.Optional(
+            CONF_MIN_WRITE_INTERVAL, default="500ms"
+        ): cv.positive_time_period_milliseconds,
+        # Number of report intervals without a valid frame before the link monitor checks on the radar
+        cv.Optional(CONF_STALL_INTERVALS, default=3): cv.int_range(min=1, max=100),
+        # The component loop sleeps while idle, this is how often the UART is checked for new bytes meanwhile.
+        # Each check is a single available() call. The interval bounds the extra delay of the first frame
+        # after an idle period, the upper limit keeps that delay below half a second.
+        cv.Optional(
+            CONF_RX_POLL_INTERVAL, default="50ms"
+        ): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=5), max=cv.TimePeriod(milliseconds=500)),
+        ),
+        cv.Optional(CONF_STREAM): STREAM_SCHEMA,
+        cv.Optional(CONF_EVENT_LOG): EVENT_LOG_SCHEMA,
+        cv.Optional(CONF_WEB): WEB_SCHEMA,
+        # auto: the underlying open report stream is switched on while someone is present or moving
+        # and switched off after unmanned_hold_time without occupancy
+        cv.Optional(CONF_UNDERLYING_OPEN_MODE, default="manual"): cv.one_of("manual", "auto", lower=True),
+        cv.Optional(
+            CONF_UNMANNED_HOLD_TIME, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_MIN_TOGGLE_INTERVAL, default="10s"
+        ): cv.positive_time_period_milliseconds,
     }
 )
 
@@ -53,10 +171,88 @@ async def to_code(config):
     await cg.register_component(var, config)
     # This line of code registers the newly created Pvariable as a device.
     await uart.register_uart_device(var, config)
+    cg.add(var.set_min_write_interval(config[CONF_MIN_WRITE_INTERVAL]))
+    cg.add(var.set_stall_intervals(config[CONF_STALL_INTERVALS]))
+    cg.add(var.set_rx_poll_interval(config[CONF_RX_POLL_INTERVAL]))
+    # Keeps the flash data of several radars apart
+    cg.add(var.set_preference_hash(zlib.crc32(str(config[CONF_ID].id).encode())))
+    if config[CONF_UNDERLYING_OPEN_MODE] == "auto":
+        cg.add(
+            var.set_adaptive_underlying_open(
+                config[CONF_UNMANNED_HOLD_TIME], config[CONF_MIN_TOGGLE_INTERVAL]
+            )
+        )
+    if stream_config := config.get(CONF_STREAM):
+        cg.add_define("USE_MR24HPC1_FRAME_RING")
+        cg.add_define("USE_MR24HPC1_STREAM")
+        cg.add(
+            var.set_stream_target(
+                str(stream_config[CONF_HOST]),
+                stream_config[CONF_PORT],
+                stream_config[CONF_PROTOCOL] == "tcp",
+            )
+        )
+        cg.add(
+            var.set_stream_batch(
+                stream_config[CONF_BATCH_SIZE], stream_config[CONF_FLUSH_INTERVAL]
+            )
+        )
+    if web_config := config.get(CONF_WEB):
+        cg.add_define("USE_MR24HPC1_FRAME_RING")
+        cg.add_define("USE_MR24HPC1_WEB")
+        base = await cg.get_variable(web_config[CONF_WEB_SERVER_BASE_ID])
+        cg.add(var.set_web_server(base, web_config[CONF_PATH]))
+    if event_log_config := config.get(CONF_EVENT_LOG):
+        cg.add_define("USE_MR24HPC1_EVENT_LOG")
+        cg.add(
+            var.set_event_log(
+                event_log_config[CONF_PAGES], event_log_config[CONF_FLUSH_INTERVAL]
+            )
+        )
+        if time_id := event_log_config.get(CONF_TIME_ID):
+            time_ = await cg.get_variable(time_id)
+            cg.add(var.set_time(time_))
+        for conf in event_log_config.get(CONF_ON_RECORD, []):
+            trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+            await automation.build_automation(
+                trigger,
+                [
+                    (cg.uint32, "timestamp"),
+                    (cg.std_string, "event"),
+                    (cg.uint8, "value"),
+                    (cg.bool_, "uptime"),
+                ],
+                conf,
+            )
 
 
+# Samples the energy of the empty room for duration, then writes thresholds just above its noise floor
 CALIBRATION_ACTION_SCHEMA = maybe_simple_id(
     {
         cv.Required(CONF_ID): cv.use_id(mr24hpc1Component),
+        cv.Optional(CONF_DURATION, default="60s"): cv.templatable(cv.positive_time_period_milliseconds),
+        cv.Optional(CONF_MARGIN, default=5): cv.templatable(cv.int_range(min=0, max=100)),
     }
 )
+
+
+@automation.register_action("mr24hpc1.calibrate", CalibrateAction, CALIBRATION_ACTION_SCHEMA)
+async def calibrate_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    duration = await cg.templatable(config[CONF_DURATION], args, cg.uint32)
+    cg.add(var.set_duration(duration))
+    margin = await cg.templatable(config[CONF_MARGIN], args, cg.uint8)
+    cg.add(var.set_margin(margin))
+    return var
+
+
+@automation.register_action(
+    "mr24hpc1.dump_event_log",
+    DumpEventLogAction,
+    maybe_simple_id({cv.Required(CONF_ID): cv.use_id(mr24hpc1Component)}),
+)
+async def dump_event_log_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
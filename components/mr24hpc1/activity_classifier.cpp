@@ -0,0 +1,147 @@
+#include "activity_classifier.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+void ActivityClassifier::set_class(uint8_t activity, int32_t bias, const int16_t weights[ACTIVITY_FEATURE_MAX])
+{
+    this->bias_[activity] = bias;
+    for (uint8_t i = 0; i < ACTIVITY_FEATURE_MAX; i++)
+    {
+        this->weights_[activity][i] = weights[i];
+    }
+}
+
+bool ActivityClassifier::feed(const UnderlyingOpenFrame &frame)
+{
+    Sample sample;
+    sample.static_energy = frame.static_energy;
+    sample.motion_energy = frame.motion_energy;
+    sample.movement_signs = frame.movement_signs;
+    sample.speed = frame.motion_speed >= 10 ? frame.motion_speed - 10 : 10 - frame.motion_speed;
+    sample.distance_jump = frame.motion_distance >= this->last_distance_ ? frame.motion_distance - this->last_distance_
+                                                                         : this->last_distance_ - frame.motion_distance;
+    if (this->filled_ == 0)
+    {
+        sample.distance_jump = 0;   // No previous report to compare with
+    }
+    this->last_distance_ = frame.motion_distance;
+
+    // Slide the window: drop the oldest sample from the sums once it is full
+    Sample &slot = this->window_[this->head_];
+    if (this->filled_ == this->window_size_)
+    {
+        this->sum_[0] -= slot.static_energy;
+        this->sum_[1] -= slot.motion_energy;
+        this->sum_[2] -= slot.movement_signs;
+        this->sum_[3] -= slot.speed;
+        this->sum_[4] -= slot.distance_jump;
+        this->motion_sum_sq_ -= (uint32_t) slot.motion_energy * slot.motion_energy;
+    }
+    else
+    {
+        this->filled_++;
+    }
+    slot = sample;
+    this->sum_[0] += sample.static_energy;
+    this->sum_[1] += sample.motion_energy;
+    this->sum_[2] += sample.movement_signs;
+    this->sum_[3] += sample.speed;
+    this->sum_[4] += sample.distance_jump;
+    this->motion_sum_sq_ += (uint32_t) sample.motion_energy * sample.motion_energy;
+    this->head_ = (this->head_ + 1) % this->window_size_;
+
+    if (this->filled_ < this->window_size_)
+        return false;   // Not enough history for stable features yet
+
+    uint8_t activity = this->classify();
+    if (activity == this->activity_)
+    {
+        this->candidate_count_ = 0;
+        return false;
+    }
+    if (activity != this->candidate_)
+    {
+        this->candidate_ = activity;
+        this->candidate_count_ = 0;
+    }
+    if (++this->candidate_count_ < this->confirm_count_)
+        return false;
+    this->activity_ = activity;
+    this->candidate_count_ = 0;
+    return true;
+}
+
+bool ActivityClassifier::set_empty() { return this->clear(ACTIVITY_EMPTY); }
+
+bool ActivityClassifier::reset() { return this->clear(ACTIVITY_UNKNOWN); }
+
+bool ActivityClassifier::clear(uint8_t activity)
+{
+    this->head_ = 0;
+    this->filled_ = 0;
+    for (auto &sum : this->sum_)
+    {
+        sum = 0;
+    }
+    this->motion_sum_sq_ = 0;
+    this->candidate_count_ = 0;
+    if (this->activity_ == activity)
+        return false;
+    this->activity_ = activity;
+    return true;
+}
+
+void ActivityClassifier::features(int32_t out[ACTIVITY_FEATURE_MAX]) const
+{
+    uint32_t n = this->filled_;
+    out[ACTIVITY_FEATURE_STATIC_ENERGY] = (this->sum_[0] << 4) / n;
+    out[ACTIVITY_FEATURE_MOTION_ENERGY] = (this->sum_[1] << 4) / n;
+    out[ACTIVITY_FEATURE_MOVEMENT_SIGNS] = (this->sum_[2] << 4) / n;
+    out[ACTIVITY_FEATURE_SPEED] = (this->sum_[3] << 4) / n;
+    out[ACTIVITY_FEATURE_DISTANCE_JUMP] = (this->sum_[4] << 4) / n;
+    // Variance in 1/256 units, its integer square root is the standard deviation in 1/16 units
+    uint32_t mean_q4 = out[ACTIVITY_FEATURE_MOTION_ENERGY];
+    uint32_t mean_sq_q8 = (this->motion_sum_sq_ << 8) / n;
+    uint32_t variance_q8 = mean_sq_q8 > mean_q4 * mean_q4 ? mean_sq_q8 - mean_q4 * mean_q4 : 0;
+    uint32_t root = 0;
+    for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2)
+    {
+        if (variance_q8 >= root + bit)
+        {
+            variance_q8 -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+    }
+    out[ACTIVITY_FEATURE_MOTION_STDDEV] = root;
+}
+
+uint8_t ActivityClassifier::classify() const
+{
+    int32_t features[ACTIVITY_FEATURE_MAX];
+    this->features(features);
+    uint8_t best = ACTIVITY_EMPTY;
+    int32_t best_score = INT32_MIN;
+    for (uint8_t activity = 0; activity < ACTIVITY_MAX; activity++)
+    {
+        // Bias is Q8 in feature units, features are Q4: scores are Q12
+        int32_t score = this->bias_[activity] * 16;
+        for (uint8_t i = 0; i < ACTIVITY_FEATURE_MAX; i++)
+        {
+            score += (int32_t) this->weights_[activity][i] * features[i];
+        }
+        if (score > best_score)
+        {
+            best_score = score;
+            best = activity;
+        }
+    }
+    return best;
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include "presence_fusion.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define ACTIVITY_WINDOW_MAX 32
+
+enum
+{
+    ACTIVITY_EMPTY = 0,
+    ACTIVITY_STILL,
+    ACTIVITY_LIGHT_MOVEMENT,
+    ACTIVITY_WALKING,
+    ACTIVITY_SEVERAL_PEOPLE,
+    ACTIVITY_MAX,
+    ACTIVITY_UNKNOWN = ACTIVITY_MAX,     // The stream stopped, nothing confirmed since
+};
+
+// Window features, all means over the window in 1/16 units
+enum
+{
+    ACTIVITY_FEATURE_STATIC_ENERGY = 0,
+    ACTIVITY_FEATURE_MOTION_ENERGY,
+    ACTIVITY_FEATURE_MOVEMENT_SIGNS,
+    ACTIVITY_FEATURE_SPEED,              // |motion speed|, 0.5 m/s steps
+    ACTIVITY_FEATURE_MOTION_STDDEV,      // standard deviation of the motion energy
+    ACTIVITY_FEATURE_DISTANCE_JUMP,      // |change of motion distance| between reports, 0.5 m steps
+    ACTIVITY_FEATURE_MAX,
+};
+
+// Linear classifier over sliding window features of the underlying open stream. The window sums
+// are updated in O(1) per frame, the class with the highest score wins and has to win confirm_count
+// frames in a row before the published activity changes. Weights are Q8, scores integer only.
+class ActivityClassifier
+{
+  public:
+    void set_window_size(uint8_t size) { this->window_size_ = size; }
+    void set_confirm_count(uint8_t count) { this->confirm_count_ = count; }
+    void set_class(uint8_t activity, int32_t bias, const int16_t weights[ACTIVITY_FEATURE_MAX]);
+
+    // Returns true when the confirmed activity changed
+    bool feed(const UnderlyingOpenFrame &frame);
+    // The radar reports the room unmanned: clear the window and settle on empty right away
+    bool set_empty();
+    // The stream stopped: clear the window, the activity is unknown until a new one is confirmed
+    bool reset();
+
+    uint8_t get_activity() const { return this->activity_; }
+
+  protected:
+    struct Sample
+    {
+        uint8_t static_energy;
+        uint8_t motion_energy;
+        uint8_t movement_signs;
+        uint8_t speed;
+        uint8_t distance_jump;
+    };
+
+    bool clear(uint8_t activity);
+    void features(int32_t out[ACTIVITY_FEATURE_MAX]) const;
+    uint8_t classify() const;
+
+    uint8_t window_size_{10};
+    uint8_t confirm_count_{3};
+    int32_t bias_[ACTIVITY_MAX]{};
+    int16_t weights_[ACTIVITY_MAX][ACTIVITY_FEATURE_MAX]{};
+
+    Sample window_[ACTIVITY_WINDOW_MAX]{};
+    uint8_t head_{0};
+    uint8_t filled_{0};
+    uint8_t last_distance_{0};
+    uint32_t sum_[5]{};                  // Running sums of the Sample fields
+    uint32_t motion_sum_sq_{0};
+
+    uint8_t activity_{ACTIVITY_EMPTY};
+    uint8_t candidate_{ACTIVITY_EMPTY};
+    uint8_t candidate_count_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "mr24hpc1.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+template<typename... Ts> class CalibrateAction : public Action<Ts...>, public Parented<mr24hpc1Component>
+{
+    TEMPLATABLE_VALUE(uint32_t, duration)
+    TEMPLATABLE_VALUE(uint8_t, margin)
+
+  public:
+    void play(Ts... x) override { this->parent_->start_calibration(this->duration_.value(x...), this->margin_.value(x...)); }
+};
+
+template<typename... Ts> class DumpEventLogAction : public Action<Ts...>, public Parented<mr24hpc1Component>
+{
+  public:
+    void play(Ts... x) override { this->parent_->dump_event_log(); }
+};
+
+#ifdef USE_MR24HPC1_EVENT_LOG
+// Fired for every record replayed by mr24hpc1.dump_event_log. The timestamp is seconds since boot
+// when uptime is set, a UNIX timestamp otherwise.
+class EventLogRecordTrigger : public Trigger<uint32_t, std::string, uint8_t, bool>
+{
+  public:
+    explicit EventLogRecordTrigger(mr24hpc1Component *parent)
+    {
+        parent->add_on_event_log_record_callback([this](const EventRecord &record) {
+            this->trigger(record.timestamp, event_type_to_str(record.type), record.value, record.type & EVENT_FLAG_UPTIME);
+        });
+    }
+};
+#endif
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -1,3 +1,5 @@
+import math
+
 import esphome.codegen as cg
 from esphome.components import binary_sensor
 import esphome.config_validation as cv
@@ -8,12 +10,82 @@ from . import CONF_MR24HPC1_ID, mr24hpc1Component
 
 AUTO_LOAD = ["mr24hpc1"]
 CONF_SOMEONEEXIST = "someoneexist"
+CONF_FUSEDPRESENCE = "fusedpresence"
+CONF_ZONES = "zones"
+
+CONF_MOTION_THRESHOLD = "motion_threshold"
+CONF_STATIC_THRESHOLD = "static_threshold"
+CONF_MOVEMENT_THRESHOLD = "movement_threshold"
+CONF_HYSTERESIS = "hysteresis"
+CONF_MAX_DISTANCE = "max_distance"
+CONF_HOLD_TIME = "hold_time"
+CONF_MIN_DISTANCE = "min_distance"
+
+MAX_ZONES = 32   # One bit per zone in the lookup table
+
+
+def validate_zone(config):
+    if config[CONF_MIN_DISTANCE] >= config[CONF_MAX_DISTANCE]:
+        raise cv.Invalid(f"{CONF_MIN_DISTANCE} must be smaller than {CONF_MAX_DISTANCE}")
+    if math.ceil(config[CONF_MIN_DISTANCE] * 2) > math.floor(config[CONF_MAX_DISTANCE] * 2):
+        raise cv.Invalid("A zone must contain at least one 0.5 m radar distance step")
+    return config
+
+
+# A zone is occupied while the target distance is in [min_distance, max_distance], it is left
+# once the distance is more than hysteresis outside of it or no target is reported.
+ZONE_SCHEMA = cv.All(
+    binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY, icon="mdi:map-marker-radius"
+    ).extend(
+        {
+            cv.Required(CONF_MIN_DISTANCE): cv.float_range(min=0.0, max=10.0),   # unit: m
+            cv.Required(CONF_MAX_DISTANCE): cv.float_range(min=0.0, max=10.0),   # unit: m
+            cv.Optional(CONF_HYSTERESIS, default=0.5): cv.float_range(min=0.0, max=5.0),   # unit: m
+        }
+    ),
+    validate_zone,
+)
+
+
+# Build the enter and stay bitmask tables indexed by the raw distance byte (0.5 m steps).
+# Raw distance 0 means no target, so it never belongs to a zone.
+def build_zone_lookup(zones):
+    size = max(math.floor((zone[CONF_MAX_DISTANCE] + zone[CONF_HYSTERESIS]) * 2) for zone in zones) + 1
+    enter = [0] * size
+    stay = [0] * size
+    for bit, zone in enumerate(zones):
+        enter_min = max(math.ceil(zone[CONF_MIN_DISTANCE] * 2), 1)
+        enter_max = math.floor(zone[CONF_MAX_DISTANCE] * 2)
+        stay_min = max(math.ceil((zone[CONF_MIN_DISTANCE] - zone[CONF_HYSTERESIS]) * 2), 1)
+        stay_max = math.floor((zone[CONF_MAX_DISTANCE] + zone[CONF_HYSTERESIS]) * 2)
+        for raw in range(enter_min, enter_max + 1):
+            enter[raw] |= 1 << bit
+        for raw in range(stay_min, stay_max + 1):
+            stay[raw] |= 1 << bit
+    return enter, stay
+
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_MR24HPC1_ID): cv.use_id(mr24hpc1Component),
     cv.Optional(CONF_SOMEONEEXIST): binary_sensor.binary_sensor_schema(
         device_class=DEVICE_CLASS_OCCUPANCY, icon="mdi:motion-sensor"
     ),
+    # Local presence from the underlying open stream, released after hold_time instead of the radar's unmanned time.
+    # A threshold of 0 disables that input.
+    cv.Optional(CONF_FUSEDPRESENCE): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY, icon="mdi:motion-sensor"
+    ).extend(
+        {
+            cv.Optional(CONF_MOTION_THRESHOLD, default=20): cv.int_range(min=0, max=250),
+            cv.Optional(CONF_STATIC_THRESHOLD, default=40): cv.int_range(min=0, max=250),
+            cv.Optional(CONF_MOVEMENT_THRESHOLD, default=5): cv.int_range(min=0, max=100),
+            cv.Optional(CONF_HYSTERESIS, default=5): cv.int_range(min=0, max=100),
+            cv.Optional(CONF_MAX_DISTANCE, default=0.0): cv.float_range(min=0.0, max=10.0),   # unit: m, 0 = no limit
+            cv.Optional(CONF_HOLD_TIME, default="5s"): cv.positive_time_period_milliseconds,
+        }
+    ),
+    cv.Optional(CONF_ZONES): cv.All(cv.ensure_list(ZONE_SCHEMA), cv.Length(min=1, max=MAX_ZONES)),
 }
 
 
@@ -22,3 +94,32 @@ async def to_code(config):
     if someoneexists_config := config.get(CONF_SOMEONEEXIST):
         sens = await binary_sensor.new_binary_sensor(someoneexists_config)
         cg.add(mr24hpc1_component.set_someoneExists_binary_sensor(sens))
+    if fusedpresence_config := config.get(CONF_FUSEDPRESENCE):
+        sens = await binary_sensor.new_binary_sensor(fusedpresence_config)
+        cg.add(mr24hpc1_component.set_fused_presence_binary_sensor(sens))
+        cg.add(
+            mr24hpc1_component.configure_presence_fusion(
+                fusedpresence_config[CONF_MOTION_THRESHOLD],
+                fusedpresence_config[CONF_STATIC_THRESHOLD],
+                fusedpresence_config[CONF_MOVEMENT_THRESHOLD],
+                fusedpresence_config[CONF_HYSTERESIS],
+                int(fusedpresence_config[CONF_MAX_DISTANCE] * 2),   # radar distance steps are 0.5 m
+                fusedpresence_config[CONF_HOLD_TIME],
+            )
+        )
+    if zones_config := config.get(CONF_ZONES):
+        enter, stay = build_zone_lookup(zones_config)
+        lut_name = f"{config[CONF_MR24HPC1_ID].id}_zone"
+        for suffix, table in (("enter", enter), ("stay", stay)):
+            values = ", ".join(f"0x{mask:08X}" for mask in table)
+            cg.add_global(cg.RawStatement(f"static constexpr uint32_t {lut_name}_{suffix}_lut[{len(table)}] = {{{values}}};"))
+        cg.add(
+            mr24hpc1_component.set_zone_lookup(
+                cg.RawExpression(f"{lut_name}_enter_lut"),
+                cg.RawExpression(f"{lut_name}_stay_lut"),
+                len(enter),
+            )
+        )
+        for zone_config in zones_config:
+            sens = await binary_sensor.new_binary_sensor(zone_config)
+            cg.add(mr24hpc1_component.add_zone_binary_sensor(sens))
@@ -4,8 +4,7 @@ namespace esphome {
 namespace mr24hpc1 {
 
 void ResetButton::press_action() {
-    uint8_t resetArray[] = {0x53, 0x59, 0x01, 0x02, 0x00, 0x01, 0x0F, 0xBF, 0x54, 0x43};
-    this->parent_->send_query(resetArray, sizeof(resetArray));
+    this->parent_->reset_module();
 }
 
 }  // namespace mr24hpc1
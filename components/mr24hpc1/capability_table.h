@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define CAPABILITY_PROBE_ATTEMPTS 3   // Unanswered requests on a healthy link before a command counts as unsupported
+#define CAPABILITY_REPROBE_MIN_MS 600000UL      // First re-probe of an unsupported verdict, doubled after every one
+#define CAPABILITY_REPROBE_MAX_MS 86400000UL
+
+// Commands that not every firmware revision answers, identified by the (control, command) of their reply.
+// The product model and id are queried until answered, the settings are read back after every write.
+enum
+{
+    CAPABILITY_PRODUCT_MODE = 0,
+    CAPABILITY_PRODUCT_ID,
+    CAPABILITY_HUMAN_STATUS,
+    CAPABILITY_KEEP_AWAY,
+    CAPABILITY_SCENE_MODE,
+    CAPABILITY_EXISTENCE_THRESHOLD,
+    CAPABILITY_MOTION_THRESHOLD,
+    CAPABILITY_MAX,
+};
+
+static const uint8_t s_capability_words[CAPABILITY_MAX][2] = {
+    {0x02, 0xA1},
+    {0x02, 0xA2},
+    {0x80, 0x81},
+    {0x80, 0x8B},
+    {0x05, 0x87},
+    {0x08, 0x88},
+    {0x08, 0x89},
+};
+
+// Persisted per firmware and hardware model: a command is decided once its probed bit is set
+struct CapabilityBitmap
+{
+    uint32_t probed;
+    uint32_t supported;
+} __attribute__((packed));
+
+// Learns which commands the connected firmware answers. Any reply marks a command supported, also
+// the active report of the same information, CAPABILITY_PROBE_ATTEMPTS requests in a row without one
+// mark it unsupported. An unsupported verdict is not final: reprobe() sends those commands again
+// without touching the persisted bitmap until a reply revises it.
+class CapabilityTable
+{
+  public:
+    void reset()
+    {
+        this->bitmap_ = {0, 0};
+        this->reprobing_ = 0;
+        for (uint8_t &attempts : this->attempts_)
+            attempts = 0;
+    }
+
+    void load(const CapabilityBitmap &bitmap)
+    {
+        this->reset();
+        this->bitmap_ = bitmap;
+    }
+
+    // Unknown commands are still sent, that is how they get probed
+    bool is_supported(uint8_t capability) const
+    {
+        uint32_t bit = 1u << capability;
+        return !(this->bitmap_.probed & bit) || (this->bitmap_.supported & bit) || (this->reprobing_ & bit);
+    }
+
+    // The verdict the entities follow, it stays unsupported while being probed again
+    bool is_unsupported(uint8_t capability) const
+    {
+        uint32_t bit = 1u << capability;
+        return (this->bitmap_.probed & bit) && !(this->bitmap_.supported & bit);
+    }
+
+    bool is_reprobing(uint8_t control, uint8_t command) const
+    {
+        int8_t capability = find(control, command);
+        return capability >= 0 && (this->reprobing_ & (1u << capability));
+    }
+
+    // Probe every unsupported command again, returns the capabilities being probed
+    uint32_t reprobe()
+    {
+        this->reprobing_ = this->bitmap_.probed & ~this->bitmap_.supported;
+        for (uint8_t i = 0; i < CAPABILITY_MAX; i++)
+        {
+            if (this->reprobing_ & (1u << i))
+                this->attempts_[i] = 0;
+        }
+        return this->reprobing_;
+    }
+
+    // Commands outside of the table are always sent
+    bool is_supported(uint8_t control, uint8_t command) const
+    {
+        int8_t capability = find(control, command);
+        return capability < 0 || this->is_supported(capability);
+    }
+
+    bool is_decided(uint8_t capability) const { return this->bitmap_.probed & (1u << capability); }
+
+    // A request expecting the given reply was sent, true when that decided the command unsupported,
+    // for the first time or again after a re-probe
+    bool sent(uint8_t control, uint8_t command)
+    {
+        int8_t capability = find(control, command);
+        if (capability < 0)
+            return false;
+        uint32_t bit = 1u << capability;
+        if (this->is_decided(capability) && !(this->reprobing_ & bit))
+            return false;
+        if (++this->attempts_[capability] < CAPABILITY_PROBE_ATTEMPTS)
+            return false;
+        this->bitmap_.probed |= bit;
+        this->reprobing_ &= ~bit;
+        return true;
+    }
+
+    // A reply or report arrived, true when that decided the command supported
+    bool answered(uint8_t control, uint8_t command)
+    {
+        int8_t capability = find(control, command);
+        if (capability < 0 && command < 0x80)
+            capability = find(control, command | 0x80);   // The active report of a queried value
+        if (capability < 0)
+            return false;
+        this->attempts_[capability] = 0;
+        uint32_t bit = 1u << capability;
+        this->reprobing_ &= ~bit;
+        if ((this->bitmap_.probed & bit) && (this->bitmap_.supported & bit))
+            return false;
+        this->bitmap_.probed |= bit;   // Also revises an earlier unsupported verdict
+        this->bitmap_.supported |= bit;
+        return true;
+    }
+
+    const CapabilityBitmap &bitmap() const { return this->bitmap_; }
+
+    static int8_t find(uint8_t control, uint8_t command)
+    {
+        for (uint8_t i = 0; i < CAPABILITY_MAX; i++)
+        {
+            if (s_capability_words[i][0] == control && s_capability_words[i][1] == command)
+                return i;
+        }
+        return -1;
+    }
+
+  protected:
+    CapabilityBitmap bitmap_{0, 0};
+    uint32_t reprobing_{0};   // Unsupported capabilities sent again, not persisted
+    uint8_t attempts_[CAPABILITY_MAX]{};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
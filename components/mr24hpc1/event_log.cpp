@@ -0,0 +1,69 @@
+#include "event_log.h"
+#ifdef USE_MR24HPC1_EVENT_LOG
+
+namespace esphome {
+namespace mr24hpc1 {
+
+static const char *const s_event_type_str[4] = {"", "presence", "motion status", "keep away"};
+
+const char *event_type_to_str(uint8_t type)
+{
+    type &= ~EVENT_FLAG_UPTIME;
+    return type > 0 && type < 4 ? s_event_type_str[type] : "unknown";
+}
+
+void EventLog::setup(uint32_t base_hash)
+{
+    // Continue after the newest page that survived the reboot
+    for (uint8_t i = 0; i < this->pages_; i++)
+    {
+        this->page_prefs_[i] = global_preferences->make_preference<EventLogPage>(base_hash + i, true);
+        EventLogPage page;
+        if (this->page_prefs_[i].load(&page) && page.seq % this->pages_ == i && page.count <= EVENT_LOG_PAGE_RECORDS &&
+            page.seq + 1 > this->next_seq_)
+        {
+            this->next_seq_ = page.seq + 1;
+        }
+    }
+}
+
+void EventLog::append(uint32_t timestamp, uint8_t type, uint8_t value)
+{
+    EventRecord &record = this->buffer_.records[this->buffer_.count++];
+    record.timestamp = timestamp;
+    record.type = type;
+    record.value = value;
+    if (this->buffer_.count == EVENT_LOG_PAGE_RECORDS)
+    {
+        this->flush();
+    }
+}
+
+void EventLog::flush()
+{
+    if (this->buffer_.count == 0)
+        return;
+    this->buffer_.seq = this->next_seq_++;
+    this->page_prefs_[this->buffer_.seq % this->pages_].save(&this->buffer_);
+    this->buffer_.count = 0;
+}
+
+void EventLog::read(const std::function<void(const EventRecord &)> &visit)
+{
+    uint32_t seq = this->next_seq_ > this->pages_ ? this->next_seq_ - this->pages_ : 0;
+    for (; seq < this->next_seq_; seq++)
+    {
+        EventLogPage page;
+        if (this->page_prefs_[seq % this->pages_].load(&page) && page.seq == seq && page.count <= EVENT_LOG_PAGE_RECORDS)
+        {
+            for (uint8_t i = 0; i < page.count; i++)
+                visit(page.records[i]);
+        }
+    }
+    for (uint8_t i = 0; i < this->buffer_.count; i++)
+        visit(this->buffer_.records[i]);
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+// Occupancy transitions recorded by the event log
+enum
+{
+    EVENT_PRESENCE = 1,      // value: 0 unmanned, 1 someone present
+    EVENT_MOTION_STATUS,     // value: 0 none, 1 motionless, 2 active
+    EVENT_KEEP_AWAY,         // value: 0 none, 1 close, 2 away
+};
+
+#ifdef USE_MR24HPC1_EVENT_LOG
+
+#define EVENT_LOG_PAGE_RECORDS 16
+#define EVENT_LOG_MAX_PAGES 32
+#define EVENT_FLAG_UPTIME 0x80   // Set in the type byte when the timestamp is seconds since boot, not epoch
+
+struct EventRecord
+{
+    uint32_t timestamp;
+    uint8_t type;
+    uint8_t value;
+} __attribute__((packed));
+
+// One batch of records, the unit written to flash
+struct EventLogPage
+{
+    uint32_t seq;
+    uint8_t count;
+    EventRecord records[EVENT_LOG_PAGE_RECORDS];
+} __attribute__((packed));
+
+const char *event_type_to_str(uint8_t type);
+
+// Occupancy transitions buffered in RAM and flushed page by page into a ring of preference slots.
+// Page seq is stored in slot seq % pages, so consecutive flushes rotate over all slots and wear
+// them evenly. Only flush() touches flash, appending is a memcpy.
+class EventLog
+{
+  public:
+    void set_pages(uint8_t pages) { this->pages_ = pages; }
+    void setup(uint32_t base_hash);
+
+    void append(uint32_t timestamp, uint8_t type, uint8_t value);
+    void flush();
+    // Visit every stored record, oldest first, followed by the ones still in RAM
+    void read(const std::function<void(const EventRecord &)> &visit);
+
+    uint8_t get_pages() const { return this->pages_; }
+    uint8_t get_buffered() const { return this->buffer_.count; }
+
+  protected:
+    uint8_t pages_{8};
+    ESPPreferenceObject page_prefs_[EVENT_LOG_MAX_PAGES];
+    EventLogPage buffer_{};
+    uint32_t next_seq_{0};   // seq of the next page written to flash
+};
+
+#endif
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "frame_ring.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define STREAM_BATCH_MAX 32
+
+// Packet sent to the collector, all fields little endian:
+//   header  'M' 'R' | version (1) | record count | dropped frames since boot (uint32)
+//   record  seq (uint32) | timestamp ms (uint32) | static energy | static distance | motion energy |
+//           motion distance | motion speed | movement signs | 2 reserved bytes
+// Over TCP the packets are simply concatenated, the count in the header delimits them.
+#define STREAM_PACKET_VERSION 1
+#define STREAM_HEADER_SIZE 8
+#define STREAM_RECORD_SIZE 16
+#define STREAM_PACKET_MAX_SIZE (STREAM_HEADER_SIZE + STREAM_BATCH_MAX * STREAM_RECORD_SIZE)
+
+// Cuts the frame ring into collector packets, in full batches or once the flush interval expired.
+// Platform independent, the streamer only adds the socket. A packet's frames stay pending until
+// commit(), so a failed send is simply encoded again on the next try.
+class FrameBatcher
+{
+  public:
+    void set_batch(uint8_t batch_size, uint32_t flush_interval)
+    {
+        this->batch_size_ = batch_size;
+        this->flush_interval_ = flush_interval;
+    }
+
+    // Drop oldest: skip whatever the ring already overwrote, then check whether a packet is due
+    bool is_due(const FrameRing<FRAME_RING_SIZE> &ring, uint32_t now)
+    {
+        if (this->cursor_ < ring.oldest_seq())
+        {
+            this->dropped_ += ring.oldest_seq() - this->cursor_;
+            this->cursor_ = ring.oldest_seq();
+        }
+        uint32_t pending = ring.next_seq() - this->cursor_;
+        if (pending == 0)
+            return false;
+        return pending >= this->batch_size_ || (now - this->last_send_ms_) >= this->flush_interval_;
+    }
+
+    // Encode the next packet into out, which holds STREAM_PACKET_MAX_SIZE bytes. Returns its length.
+    size_t encode(const FrameRing<FRAME_RING_SIZE> &ring, uint8_t *out)
+    {
+        uint32_t pending = ring.next_seq() - this->cursor_;
+        uint8_t count = pending < this->batch_size_ ? pending : this->batch_size_;
+        uint8_t *start = out;
+        out[0] = 'M';
+        out[1] = 'R';
+        out[2] = STREAM_PACKET_VERSION;
+        out[3] = count;
+        put_uint32(&out[4], this->dropped_);
+        out += STREAM_HEADER_SIZE;
+        for (uint8_t i = 0; i < count; i++, out += STREAM_RECORD_SIZE)
+        {
+            const FrameRecord *record = ring.get(this->cursor_ + i);
+            put_uint32(&out[0], record->seq);
+            put_uint32(&out[4], record->timestamp_ms);
+            out[8] = record->frame.static_energy;
+            out[9] = record->frame.presence_distance;
+            out[10] = record->frame.motion_energy;
+            out[11] = record->frame.motion_distance;
+            out[12] = record->frame.motion_speed;
+            out[13] = record->frame.movement_signs;
+            out[14] = 0;
+            out[15] = 0;
+        }
+        this->encoded_ = count;
+        return out - start;
+    }
+
+    // The packet encoded last was sent
+    void commit(uint32_t now)
+    {
+        this->cursor_ += this->encoded_;
+        this->encoded_ = 0;
+        this->last_send_ms_ = now;
+    }
+
+    bool has_pending(const FrameRing<FRAME_RING_SIZE> &ring) const { return ring.next_seq() != this->cursor_; }
+    // Time until pending frames are due by the flush interval. Once that passed and they are still
+    // pending the send failed, the next try is one flush interval later.
+    uint32_t flush_delay(uint32_t now) const
+    {
+        uint32_t elapsed = now - this->last_send_ms_;
+        return elapsed < this->flush_interval_ ? this->flush_interval_ - elapsed : this->flush_interval_;
+    }
+    uint32_t get_dropped() const { return this->dropped_; }
+    uint8_t get_batch_size() const { return this->batch_size_; }
+    uint32_t get_flush_interval() const { return this->flush_interval_; }
+
+  protected:
+    static void put_uint32(uint8_t *out, uint32_t value)
+    {
+        out[0] = value;
+        out[1] = value >> 8;
+        out[2] = value >> 16;
+        out[3] = value >> 24;
+    }
+
+    uint8_t batch_size_{16};
+    uint32_t flush_interval_{1000};
+    uint32_t cursor_{0};             // next sequence number to send
+    uint32_t dropped_{0};
+    uint32_t last_send_ms_{0};
+    uint8_t encoded_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define COALESCE_CONTROL_WORD 0x08      // Underlying open report stream
+#define COALESCE_FRAME_MAX_SIZE 16      // The largest stream report, 0x08/0x01, is 14 bytes
+
+// Periodic reports of the underlying open stream, a newer one of the same command supersedes an older one.
+// The 0x8X query replies are answers to requests and are never coalesced.
+static const uint8_t s_coalesce_commands[] = {0x01, 0x07};
+#define COALESCE_SLOTS (sizeof(s_coalesce_commands) / sizeof(s_coalesce_commands[0]))
+
+// Holds the newest frame of each stream report while the UART is drained, for its entity publishes.
+// The frame consumers have seen every report on arrival already. Everything else is dispatched as it
+// arrives, so presence and motion changes never wait behind a telemetry backlog.
+class FrameCoalescer
+{
+  public:
+    // Keeps the frame when it is a stream report, false when it has to be dispatched right away
+    bool offer(const uint8_t *frame, size_t len, uint8_t control, uint8_t command)
+    {
+        if (control != COALESCE_CONTROL_WORD || len > COALESCE_FRAME_MAX_SIZE)
+            return false;
+        int8_t slot = find(command);
+        if (slot < 0)
+            return false;
+        this->remove(slot);
+        if (this->lens_[slot] != 0)
+            this->coalesced_++;   // Replaced before it was published
+        memcpy(this->frames_[slot], frame, len);
+        this->lens_[slot] = len;
+        this->order_[this->pending_++] = slot;
+        return true;
+    }
+
+    // Dispatch the kept frames in the order their newest version arrived
+    template<typename F> void flush(F &&dispatch)
+    {
+        for (uint8_t i = 0; i < this->pending_; i++)
+        {
+            uint8_t slot = this->order_[i];
+            dispatch(this->frames_[slot], this->lens_[slot]);
+            this->lens_[slot] = 0;
+        }
+        this->pending_ = 0;
+    }
+
+    void clear()
+    {
+        for (uint8_t i = 0; i < this->pending_; i++)
+            this->lens_[this->order_[i]] = 0;
+        this->pending_ = 0;
+    }
+
+    bool has_pending() const { return this->pending_ != 0; }
+    uint32_t coalesced() const { return this->coalesced_; }
+
+  protected:
+    static int8_t find(uint8_t command)
+    {
+        for (uint8_t i = 0; i < COALESCE_SLOTS; i++)
+        {
+            if (s_coalesce_commands[i] == command)
+                return i;
+        }
+        return -1;
+    }
+
+    void remove(uint8_t slot)
+    {
+        if (this->lens_[slot] == 0)
+            return;
+        uint8_t j = 0;
+        for (uint8_t i = 0; i < this->pending_; i++)
+        {
+            if (this->order_[i] != slot)
+                this->order_[j++] = this->order_[i];
+        }
+        this->pending_ = j;
+    }
+
+    uint8_t frames_[COALESCE_SLOTS][COALESCE_FRAME_MAX_SIZE];
+    uint8_t lens_[COALESCE_SLOTS]{};     // 0 = slot empty
+    uint8_t order_[COALESCE_SLOTS];
+    uint8_t pending_{0};
+    uint32_t coalesced_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "presence_fusion.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define FRAME_RING_SIZE 64
+
+// One decoded underlying open frame as handed to the frame consumers
+struct FrameRecord
+{
+    uint32_t seq;
+    uint32_t timestamp_ms;
+    UnderlyingOpenFrame frame;
+};
+
+// Preallocated ring of the most recent frames. The writer never waits: every reader keeps its own
+// sequence number cursor and a reader that falls more than N frames behind loses the oldest ones.
+// push(), next_seq(), oldest_seq() and get() belong to the main loop. Readers on another task copy the
+// frames with try_snapshot(), a seqlock: the version is odd while push() writes a record.
+template<size_t N> class FrameRing
+{
+    static_assert((N & (N - 1)) == 0, "FrameRing size must be a power of two");
+
+  public:
+    void push(const UnderlyingOpenFrame &frame, uint32_t now)
+    {
+        uint32_t version = this->version_.load(std::memory_order_relaxed);
+        this->version_.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint32_t seq = this->next_seq_.load(std::memory_order_relaxed);
+        FrameRecord &record = this->records_[seq & (N - 1)];
+        record.seq = seq;
+        record.timestamp_ms = now;
+        record.frame = frame;
+        this->next_seq_.store(seq + 1, std::memory_order_relaxed);
+        this->version_.store(version + 2, std::memory_order_release);
+    }
+
+    // Sequence number the next pushed frame will get
+    uint32_t next_seq() const { return this->next_seq_.load(std::memory_order_relaxed); }
+    uint32_t oldest_seq() const { return this->next_seq() > N ? this->next_seq() - N : 0; }
+
+    // nullptr when seq has not been written yet or was already overwritten
+    const FrameRecord *get(uint32_t seq) const
+    {
+        if (seq >= this->next_seq() || seq < this->oldest_seq())
+            return nullptr;
+        return &this->records_[seq & (N - 1)];
+    }
+
+    // Copies the frames from seq on into out (room for N records), count gets how many and next the
+    // sequence number after the last one. False when a push overlapped the copy, the caller tries again
+    // later: spinning here would starve the main loop on a single core.
+    bool try_snapshot(uint32_t seq, FrameRecord *out, size_t *count, uint32_t *next) const
+    {
+        uint32_t version = this->version_.load(std::memory_order_acquire);
+        if (version & 1)
+            return false;
+        uint32_t next_seq = this->next_seq_.load(std::memory_order_relaxed);
+        uint32_t oldest = next_seq > N ? next_seq - N : 0;
+        if (seq < oldest)
+            seq = oldest;
+        size_t copied = 0;
+        for (; seq < next_seq; seq++)
+            out[copied++] = this->records_[seq & (N - 1)];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->version_.load(std::memory_order_relaxed) != version)
+            return false;
+        *count = copied;
+        *next = next_seq;
+        return true;
+    }
+
+  protected:
+    FrameRecord records_[N]{};
+    std::atomic<uint32_t> next_seq_{0};
+    std::atomic<uint32_t> version_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,79 @@
+#include "frame_stream.h"
+#ifdef USE_MR24HPC1_STREAM
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cinttypes>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+static const char *TAG = "mr24hpc1.stream";
+
+void FrameStreamer::dump_config(const char *tag)
+{
+    ESP_LOGCONFIG(tag, "  Stream: %s %s:%u, batch %u, flush %" PRIu32 " ms", this->tcp_ ? "TCP" : "UDP",
+                  this->host_.c_str(), this->port_, this->batcher_.get_batch_size(), this->batcher_.get_flush_interval());
+}
+
+bool FrameStreamer::connect_(uint32_t now)
+{
+    if (this->socket_ != nullptr)
+        return true;
+    if (this->connect_attempted_ && (now - this->last_connect_ms_) < STREAM_RECONNECT_MS)
+        return false;
+    this->connect_attempted_ = true;
+    this->last_connect_ms_ = now;
+    this->socket_ = socket::socket_ip(this->tcp_ ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (this->socket_ == nullptr)
+    {
+        ESP_LOGW(TAG, "Could not create socket, errno %d", errno);
+        return false;
+    }
+    this->socket_->setblocking(false);
+    struct sockaddr_storage addr;
+    socklen_t addr_len = socket::set_sockaddr((struct sockaddr *) &addr, sizeof(addr), this->host_, this->port_);
+    // UDP is connected too, so both protocols can simply write()
+    if (this->socket_->connect((struct sockaddr *) &addr, addr_len) != 0 && errno != EINPROGRESS)
+    {
+        ESP_LOGW(TAG, "Could not connect to %s:%u, errno %d", this->host_.c_str(), this->port_, errno);
+        this->close_();
+        return false;
+    }
+    return true;
+}
+
+void FrameStreamer::close_()
+{
+    if (this->socket_ != nullptr)
+    {
+        this->socket_->close();
+        this->socket_ = nullptr;
+    }
+}
+
+void FrameStreamer::process(const FrameRing<FRAME_RING_SIZE> &ring, uint32_t now)
+{
+    if (!this->batcher_.is_due(ring, now) || !this->connect_(now))
+        return;
+    size_t len = this->batcher_.encode(ring, this->packet_);
+    ssize_t sent = this->socket_->write(this->packet_, len);
+    if (sent == (ssize_t) len)
+    {
+        this->batcher_.commit(now);
+    }
+    else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == ENOTCONN))
+    {
+        // Not connected yet or the send buffer is full, the ring keeps the frames until the next try
+    }
+    else
+    {
+        // A partial TCP write would desync the stream, start over on a new connection
+        ESP_LOGW(TAG, "Send to %s:%u failed, errno %d", this->host_.c_str(), this->port_, errno);
+        this->close_();
+    }
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_MR24HPC1_STREAM
+#include "esphome/components/socket/socket.h"
+#include "frame_batcher.h"
+
+#include <memory>
+#include <string>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define STREAM_RECONNECT_MS 5000
+
+// Sends the batches of the frame ring to a collector over UDP or TCP, see frame_batcher.h for the packet layout
+class FrameStreamer
+{
+  public:
+    void set_target(const std::string &host, uint16_t port, bool tcp)
+    {
+        this->host_ = host;
+        this->port_ = port;
+        this->tcp_ = tcp;
+    }
+    void set_batch(uint8_t batch_size, uint32_t flush_interval) { this->batcher_.set_batch(batch_size, flush_interval); }
+    // Send whatever the ring holds past our cursor, in full batches or once the flush interval expired
+    void process(const FrameRing<FRAME_RING_SIZE> &ring, uint32_t now);
+    bool has_pending(const FrameRing<FRAME_RING_SIZE> &ring) const { return this->batcher_.has_pending(ring); }
+    uint32_t flush_delay(uint32_t now) const { return this->batcher_.flush_delay(now); }
+    uint32_t get_dropped() const { return this->batcher_.get_dropped(); }
+    void dump_config(const char *tag);
+
+  protected:
+    bool connect_(uint32_t now);
+    void close_();
+
+    std::string host_;
+    uint16_t port_{0};
+    bool tcp_{false};
+    FrameBatcher batcher_;
+    std::unique_ptr<socket::Socket> socket_;
+    uint32_t last_connect_ms_{0};
+    bool connect_attempted_{false};
+    uint8_t packet_[STREAM_PACKET_MAX_SIZE];
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
+#endif
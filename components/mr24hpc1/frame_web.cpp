@@ -0,0 +1,151 @@
+#include "frame_web.h"
+#ifdef USE_MR24HPC1_WEB
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+// Fills the chart from the frames endpoint, asking again a few times while it is busy, then follows the event source of the chosen rate and draws
+// the last 120 frames. The path of the hub goes between head and tail.
+static const char *const PAGE_HEAD = "<!DOCTYPE html><html><head><meta charset=utf-8><title>MR24HPC1 live</title></head>"
+                                     "<body style='font-family:sans-serif'><h3>MR24HPC1 live</h3>Rate <select id=r>"
+                                     "<option>1<option selected>2<option>5<option>10<option>20</select> Hz <span id=s></span><br>"
+                                     "<canvas id=e width=720 height=200></canvas><br><canvas id=d width=720 height=200></canvas>"
+                                     "<script>const P='";
+static const char *const PAGE_TAIL =
+    "';let n=0,F=[],E=null;"
+    "function plot(id,a,b,max,la,lb){const c=document.getElementById(id).getContext('2d');c.clearRect(0,0,720,200);"
+    "[[a,'#d33',la],[b,'#36c',lb]].forEach(([k,col,l],j)=>{c.strokeStyle=col;c.fillStyle=col;c.fillText(l,8,14+j*14);"
+    "c.beginPath();F.forEach((f,i)=>{const x=i*6,y=195-f[k]*190/max;i?c.lineTo(x,y):c.moveTo(x,y)});c.stroke()})}"
+    "function draw(){plot('e',2,4,250,'static energy','motion energy');"
+    "plot('d',3,5,20,'presence distance (0.5 m)','motion distance (0.5 m)')}"
+    "async function follow(){const r=document.getElementById('r').value;if(E)E.close();"
+    "for(let t=0;t<5;t++){try{const q=await fetch(P+'/frames?since='+n+'&rate='+r);"
+    "if(q.status==503){await new Promise(w=>setTimeout(w,20));continue}const j=await q.json();"
+    "n=j.next;F=F.concat(j.frames).slice(-120);"
+    "document.getElementById('s').textContent=j.dropped?j.dropped+' dropped':'';draw()}catch(e){}break}"
+    "E=new EventSource(P+'/events/'+r);E.addEventListener('frame',m=>{const f=JSON.parse(m.data);if(f[0]<n)return;"
+    "n=f[0]+1;F.push(f);F=F.slice(-120);draw()})}"
+    "document.getElementById('r').onchange=follow;follow()</script></body></html>";
+
+FrameWebHandler::FrameWebHandler(const FrameRing<FRAME_RING_SIZE> *ring, const std::string &path) : ring_(ring), path_(path)
+{
+    for (uint8_t i = 0; i < WEB_RATE_COUNT; i++)
+    {
+        this->events_[i] = new AsyncEventSource(path + "/events/" + std::to_string(s_web_rates[i]));  // NOLINT
+    }
+}
+
+void FrameWebHandler::register_handlers(web_server_base::WebServerBase *base)
+{
+    base->add_handler(this);
+    for (AsyncEventSource *events : this->events_)
+    {
+        base->add_handler(events);
+    }
+}
+
+// Each rate sends a frame at least 1/rate s after the one it sent before, to every viewer of that rate
+void FrameWebHandler::publish(const FrameRecord &record)
+{
+    char message[80];
+    int len = -1;
+    for (uint8_t i = 0; i < WEB_RATE_COUNT; i++)
+    {
+        if (this->sent_[i] && (record.timestamp_ms - this->last_sent_ms_[i]) < 1000u / s_web_rates[i])
+            continue;
+        this->sent_[i] = true;
+        this->last_sent_ms_[i] = record.timestamp_ms;
+        if (this->events_[i]->count() == 0)
+            continue;
+        if (len < 0)
+        {
+            // seq, timestamp, static energy, presence distance, motion energy, motion distance, motion speed, movement signs
+            len = snprintf(message, sizeof(message), "[%" PRIu32 ",%" PRIu32 ",%u,%u,%u,%u,%u,%u]", record.seq,
+                           record.timestamp_ms, record.frame.static_energy, record.frame.presence_distance,
+                           record.frame.motion_energy, record.frame.motion_distance, record.frame.motion_speed,
+                           record.frame.movement_signs);
+        }
+        this->events_[i]->send(message, "frame", record.seq);
+    }
+}
+
+bool FrameWebHandler::canHandle(AsyncWebServerRequest *request) const
+{
+    if (request->method() != HTTP_GET)
+        return false;
+    std::string url = request->url().c_str();
+    return url == this->path_ || url == this->path_ + "/frames";   // The event sources handle their own paths
+}
+
+void FrameWebHandler::handleRequest(AsyncWebServerRequest *request)
+{
+    std::string url = request->url().c_str();
+    if (url != this->path_)
+    {
+        this->handle_frames(request);
+        return;
+    }
+    AsyncResponseStream *stream = request->beginResponseStream("text/html");
+    stream->print(PAGE_HEAD);
+    stream->print(this->path_.c_str());
+    stream->print(PAGE_TAIL);
+    request->send(stream);
+}
+
+uint32_t FrameWebHandler::get_param(AsyncWebServerRequest *request, const char *name, uint32_t fallback)
+{
+    if (!request->hasParam(name))
+        return fallback;
+    return strtoul(request->getParam(name)->value().c_str(), nullptr, 10);
+}
+
+// Backfill for a page that just opened or switched rate: of the frames past since, only those at
+// least 1/rate s after the previously returned one are sent. The page follows the events from next on.
+void FrameWebHandler::handle_frames(AsyncWebServerRequest *request)
+{
+    uint32_t seq = this->get_param(request, "since", 0);
+    uint32_t rate = this->get_param(request, "rate", WEB_RATE_DEFAULT);
+    if (rate == 0 || rate > WEB_RATE_MAX)
+    {
+        rate = WEB_RATE_DEFAULT;
+    }
+    uint32_t spacing_ms = 1000 / rate;
+    size_t count = 0;
+    uint32_t next_seq = 0;
+    if (!this->ring_->try_snapshot(seq, this->snapshot_, &count, &next_seq))
+    {
+        request->send(503, "text/plain", "Busy");   // A push overlapped the copy, the page asks again
+        return;
+    }
+    if (seq > next_seq)
+    {
+        seq = next_seq;   // The device restarted, begin with the frames that are there now
+    }
+    uint32_t dropped = next_seq - count - seq;
+
+    AsyncResponseStream *stream = request->beginResponseStream("application/json");
+    stream->printf("{\"next\":%" PRIu32 ",\"dropped\":%" PRIu32 ",\"frames\":[", next_seq, dropped);
+    bool first = true;
+    uint32_t last_ms = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const FrameRecord &record = this->snapshot_[i];
+        if (!first && (record.timestamp_ms - last_ms) < spacing_ms)
+            continue;
+        stream->printf("%s[%" PRIu32 ",%" PRIu32 ",%u,%u,%u,%u,%u,%u]", first ? "" : ",", record.seq, record.timestamp_ms,
+                       record.frame.static_energy, record.frame.presence_distance, record.frame.motion_energy,
+                       record.frame.motion_distance, record.frame.motion_speed, record.frame.movement_signs);
+        first = false;
+        last_ms = record.timestamp_ms;
+    }
+    stream->print("]}");
+    request->send(stream);
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_MR24HPC1_WEB
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "frame_ring.h"
+
+#include <string>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define WEB_RATE_DEFAULT 2    // frames per second when the client does not ask for a rate
+#define WEB_RATE_MAX 20
+#define WEB_RATE_COUNT 5
+
+// Rates a viewer can pick, each one is its own event source
+static const uint8_t s_web_rates[WEB_RATE_COUNT] = {1, 2, 5, 10, 20};
+
+// Live view of the underlying open stream, served by the web server:
+//   <path>                               live chart page
+//   <path>/frames?since=<seq>&rate=<hz>  JSON of the frames still in the ring from seq on, fills the chart on load
+//   <path>/events/<hz>                   server-sent "frame" events, live at one of s_web_rates
+// The main loop decimates every pushed frame once per rate and formats it only for rates that have viewers.
+// The frames request runs on the web server task and copies the ring with its seqlock. It never waits
+// for the main loop: when a push overlaps the copy it answers 503 and the page asks again.
+class FrameWebHandler : public AsyncWebHandler
+{
+  public:
+    FrameWebHandler(const FrameRing<FRAME_RING_SIZE> *ring, const std::string &path);
+
+    // Adds the page, the frames endpoint and the event sources to the web server
+    void register_handlers(web_server_base::WebServerBase *base);
+    // Main loop, after every push to the ring
+    void publish(const FrameRecord &record);
+
+    bool canHandle(AsyncWebServerRequest *request) const override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+  protected:
+    void handle_frames(AsyncWebServerRequest *request);
+    uint32_t get_param(AsyncWebServerRequest *request, const char *name, uint32_t fallback);
+
+    const FrameRing<FRAME_RING_SIZE> *ring_;
+    std::string path_;
+    AsyncEventSource *events_[WEB_RATE_COUNT]{};
+    uint32_t last_sent_ms_[WEB_RATE_COUNT]{};
+    bool sent_[WEB_RATE_COUNT]{};
+    FrameRecord snapshot_[FRAME_RING_SIZE];   // Web server task only
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
+#endif
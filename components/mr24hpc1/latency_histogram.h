@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define LATENCY_HISTOGRAM_BUCKETS 24   // bucket i counts [2^i, 2^(i+1)) us, the last bucket is open ended (> 8 s)
+
+// Fixed size latency histogram with power-of-two buckets, recording is O(1) and never allocates
+class LatencyHistogram
+{
+  public:
+    void record(uint32_t us)
+    {
+        uint8_t bucket = 0;
+        while ((us >> bucket) > 1 && bucket < LATENCY_HISTOGRAM_BUCKETS - 1)
+        {
+            bucket++;
+        }
+        this->buckets_[bucket]++;
+        this->count_++;
+        if (us > this->max_)
+        {
+            this->max_ = us;
+        }
+    }
+
+    // Upper bound of the bucket holding the requested percentile, 0 when nothing was recorded
+    uint32_t percentile(uint8_t pct) const
+    {
+        if (this->count_ == 0)
+            return 0;
+        uint32_t rank = (uint32_t) (((uint64_t) this->count_ * pct + 99) / 100);
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        {
+            seen += this->buckets_[i];
+            if (seen >= rank)
+            {
+                uint32_t upper = (i == LATENCY_HISTOGRAM_BUCKETS - 1) ? this->max_ : (2u << i) - 1;
+                return upper < this->max_ ? upper : this->max_;
+            }
+        }
+        return this->max_;
+    }
+
+    // Start a new window, the percentiles only cover what was recorded since
+    void reset()
+    {
+        for (uint32_t &bucket : this->buckets_)
+            bucket = 0;
+        this->count_ = 0;
+        this->max_ = 0;
+    }
+
+    uint32_t count() const { return this->count_; }
+    uint32_t max() const { return this->max_; }
+
+  protected:
+    uint32_t buckets_[LATENCY_HISTOGRAM_BUCKETS]{};
+    uint32_t count_{0};
+    uint32_t max_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
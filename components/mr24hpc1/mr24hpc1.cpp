@@ -1,6 +1,10 @@
+#include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 #include "mr24hpc1.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
 #include <utility>
 #ifdef USE_NUMBER
 #include "esphome/components/number/number.h"
@@ -14,34 +18,17 @@ namespace mr24hpc1 {
 
 static const char *TAG = "mr24hpc1";
 
-// Calculate CRC check digit
-static uint8_t get_frame_crc_sum(uint8_t *data, int len)
+// Reports the radar sends on its own. The heartbeat and the replies to queries, which have the
+// high bit of the command word set, also arrive from a radar whose report stream is stuck.
+static inline bool is_report_frame(uint8_t control, uint8_t command)
 {
-    unsigned int crc_sum = 0;
-    for (int i = 0; i < len - 3; i++)
-    {
-        crc_sum += data[i];
-    }
-    return crc_sum & 0xff;
-}
-
-// Check that the check digit is correct
-static int get_frame_check_status(uint8_t *data, int len)
-{
-    uint8_t crc_sum = get_frame_crc_sum(data, len);
-    uint8_t verified = data[len - 3];
-    return (verified == crc_sum) ? 1 : 0;
+    return control != 0x01 && command < 0x80;
 }
 
-// Print data frame
-static void show_frame_data(uint8_t *data, int len)
+// Log a frame sent to the radar, only at the verbose level
+static void show_frame_data(const uint8_t *data, size_t len)
 {
-    printf("[%s] FRAME: %d, ", __FUNCTION__, len);
-    for (int i = 0; i < len; i++)
-    {
-        printf("%02X ", data[i] & 0xff);
-    }
-    printf("\r\n");
+    ESP_LOGV(TAG, "Sent frame: %s", format_hex_pretty(data, len).c_str());
 }
 
 // Prints the component's configuration data. dump_config() prints all of the component's configuration items in an easy-to-read format, including the configuration key-value pairs.
@@ -55,9 +42,17 @@ void mr24hpc1Component::dump_config() {
     LOG_TEXT_SENSOR(" ", "FirwareVerisonTextSensor", this->firware_version_text_sensor_);
     LOG_TEXT_SENSOR(" ", "KeepAwaySensor", this->keep_away_text_sensor_);
     LOG_TEXT_SENSOR(" ", "MotionStatusSensor", this->motion_status_text_sensor_);
+    LOG_TEXT_SENSOR(" ", "WriteStatusTextSensor", this->write_status_text_sensor_);
+    LOG_TEXT_SENSOR(" ", "ReportStatusTextSensor", this->report_status_text_sensor_);
+    LOG_TEXT_SENSOR(" ", "ActivityTextSensor", this->activity_text_sensor_);
 #endif
 #ifdef USE_BINARY_SENSOR
     LOG_BINARY_SENSOR(" ", "SomeoneExistsBinarySensor", this->someoneExists_binary_sensor_);
+    LOG_BINARY_SENSOR(" ", "FusedPresenceBinarySensor", this->fused_presence_binary_sensor_);
+    for (auto *zone : this->zone_binary_sensors_)
+    {
+        LOG_BINARY_SENSOR(" ", "ZoneBinarySensor", zone);
+    }
 #endif
 #ifdef USE_SENSOR
     LOG_SENSOR(" ", "CustomPresenceOfDetectionSensor", this->custom_presence_of_detection_sensor_);
@@ -66,6 +61,17 @@ void mr24hpc1Component::dump_config() {
     LOG_SENSOR(" ", "customspatialstaticvalue", this->custom_spatial_static_value_sensor_);
     LOG_SENSOR(" ", "customspatialmotionvalue", this->custom_spatial_motion_value_sensor_);
     LOG_SENSOR(" ", "custommotionspeed", this->custom_motion_speed_sensor_);
+    LOG_SENSOR(" ", "ReceiveLatencySensor", this->receive_latency_sensor_);
+    LOG_SENSOR(" ", "ParseLatencySensor", this->parse_latency_sensor_);
+    LOG_SENSOR(" ", "DispatchLatencySensor", this->dispatch_latency_sensor_);
+    LOG_SENSOR(" ", "PublishLatencySensor", this->publish_latency_sensor_);
+    LOG_SENSOR(" ", "PresenceLatencySensor", this->presence_latency_sensor_);
+    LOG_SENSOR(" ", "HeartbeatRttSensor", this->heartbeat_rtt_sensor_);
+    LOG_SENSOR(" ", "HeartbeatMissesSensor", this->heartbeat_misses_sensor_);
+    LOG_SENSOR(" ", "CoalescedFramesSensor", this->coalesced_frames_sensor_);
+    LOG_SENSOR(" ", "TrackedDistanceSensor", this->tracked_distance_sensor_);
+    LOG_SENSOR(" ", "TrackedVelocitySensor", this->tracked_velocity_sensor_);
+    LOG_SENSOR(" ", "ArrivalTimeSensor", this->arrival_time_sensor_);
 #endif
 #ifdef USE_SWITCH
     LOG_SWITCH(" ", "underly_open_function", this->underly_open_function_switch_);
@@ -75,15 +81,68 @@ void mr24hpc1Component::dump_config() {
 #endif
 #ifdef USE_SELECT
     LOG_SELECT(" ", "SceneModeSelect", this->scene_mode_select_);
+#endif
+    ESP_LOGCONFIG(TAG, "  Min write interval: %" PRIu32 " ms", this->min_write_interval_);
+    ESP_LOGCONFIG(TAG, "  RX stall after: %u report intervals", this->stall_intervals_);
+    if (this->adaptive_stream_)
+    {
+        ESP_LOGCONFIG(TAG, "  Underlying open: auto, off after %" PRIu32 " ms unmanned, min toggle interval %" PRIu32 " ms",
+                      this->unmanned_hold_time_, this->min_toggle_interval_);
+    }
+#ifdef USE_MR24HPC1_STREAM
+    this->streamer_.dump_config(TAG);
+#endif
+#ifdef USE_MR24HPC1_WEB
+    ESP_LOGCONFIG(TAG, "  Live view: %s", this->web_path_.c_str());
+#endif
+#ifdef USE_MR24HPC1_EVENT_LOG
+    ESP_LOGCONFIG(TAG, "  Event log: %u pages of %u records, flushed every %" PRIu32 " ms", this->event_log_.get_pages(),
+                  EVENT_LOG_PAGE_RECORDS, this->event_log_flush_interval_);
 #endif
 }
 
 // Initialisation functions
 void mr24hpc1Component::setup() {
-    s_power_on_status = 0;
-    sg_init_flag = true;
+    this->power_on_status_ = 0;
+    this->init_flag_ = true;
     ESP_LOGCONFIG(TAG, "uart_settings is 115200");
     this->check_uart_settings(115200);
+    this->last_valid_frame_ms_ = millis();
+    this->last_report_ms_ = this->last_valid_frame_ms_;
+#ifdef USE_BINARY_SENSOR
+    // Only a distance frame of the stream publishes a zone, with the stream off that may never come
+    for (binary_sensor::BinarySensor *zone_binary_sensor : this->zone_binary_sensors_)
+    {
+        zone_binary_sensor->publish_state(false);
+    }
+#endif
+
+    // Reapply the thresholds of the last calibration instead of calibrating again
+    this->calibration_pref_ = global_preferences->make_preference<CalibrationResult>(fnv1_hash("mr24hpc1_calibration") ^ this->preference_hash_, true);
+    CalibrationResult calibration;
+    if (this->calibration_pref_.load(&calibration))
+    {
+        ESP_LOGCONFIG(TAG, "Restoring calibrated thresholds, existence %u, motion %u", calibration.existence_threshold, calibration.motion_threshold);
+        this->apply_calibration(calibration);
+    }
+#ifdef USE_MR24HPC1_WEB
+    this->web_base_->init();
+    this->web_handler_ = new FrameWebHandler(&this->frame_ring_, this->web_path_);  // NOLINT
+    this->web_handler_->register_handlers(this->web_base_);
+#endif
+    // loop() sleeps while there is nothing to do, this wakes it up once the radar sends something.
+    // The UART driver offers no receive callback, so this is a bounded poll of one available() call
+    // per rx_poll_interval, see tests/host/bench_idle_loop.cpp for what an idle radar costs.
+    this->set_interval("rx_poll", this->rx_poll_interval_, [this]() {
+        if (this->available())
+        {
+            this->enable_loop();
+        }
+    });
+#ifdef USE_MR24HPC1_EVENT_LOG
+    this->event_log_.setup(fnv1_hash("mr24hpc1_event_log") ^ this->preference_hash_);
+    this->set_interval("event_log_flush", this->event_log_flush_interval_, [this]() { this->event_log_.flush(); });
+#endif
 
     memset(this->c_product_mode, 0, PRODUCT_BUF_MAX_SIZE);
     memset(this->c_product_id, 0, PRODUCT_BUF_MAX_SIZE);
@@ -91,38 +150,53 @@ void mr24hpc1Component::setup() {
     memset(this->c_hardware_model, 0, PRODUCT_BUF_MAX_SIZE);
 }
 
+// Keep the buffered events across an OTA update or a commanded reboot
+void mr24hpc1Component::on_shutdown() {
+#ifdef USE_MR24HPC1_EVENT_LOG
+    this->event_log_.flush();
+#endif
+}
+
 // component callback function, which is called every time the loop is called
 void mr24hpc1Component::update() {
-    if (!sg_init_flag)                // The setup function is complete.
+    if (!this->init_flag_)                // The setup function is complete.
         return;
-    if (sg_init_flag && (255 != sg_heartbeat_flag))  // The initial value of sg_heartbeat_flag is 255, so it is not executed for the first time, and the power-up check is executed first
+    this->enable_loop();            // Run the query sequence step of this interval
+    this->check_link();             // RX stall detection while loop() sleeps
+    this->publish_latency();
+    if (this->coalesced_frames_sensor_ != nullptr)
     {
-        sg_heartbeat_flag = 1;
-        this->heartbeat_state_text_sensor_->publish_state(s_heartbeat_str[sg_heartbeat_flag]);
+        this->coalesced_frames_sensor_->publish_state(this->coalescer_.coalesced());
     }
-    if (s_power_on_status < 4)  // Post power-up status check
+    this->check_report_intervals();
+    this->update_adaptive_stream();
+    if (!this->heartbeat_pending_ && this->recovery_step_ == LINK_RECOVERY_NONE)
     {
-        if (s_output_info_switch_flag == OUTPUT_SWITCH_INIT)  // Power-up status check first item
+        this->get_heartbeat_packet();   // One heartbeat per report interval, check_link() times the reply
+    }
+    if (this->power_on_status_ < 4)  // Post power-up status check
+    {
+        if (this->output_info_switch_flag_ == OUTPUT_SWITCH_INIT)  // Power-up status check first item
         {
-            sg_start_query_data = CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH;  // Custom function to query radar output information switch
-            sg_start_query_data_max = CUSTOM_FUNCTION_MAX;
+            this->start_query_data_ = CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH;  // Custom function to query radar output information switch
+            this->start_query_data_max_ = CUSTOM_FUNCTION_MAX;
         }
-        else if (s_output_info_switch_flag == OUTPUT_SWTICH_OFF)  // When the bottom open parameter button is closed, the power-up status checks the second item
+        else if (this->output_info_switch_flag_ == OUTPUT_SWTICH_OFF)  // When the bottom open parameter button is closed, the power-up status checks the second item
         {
-            sg_start_query_data = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
-            sg_start_query_data_max = STANDARD_FUNCTION_MAX;
+            this->start_query_data_ = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
+            this->start_query_data_max_ = STANDARD_FUNCTION_MAX;
         }
-        else if (s_output_info_switch_flag == OUTPUT_SWTICH_ON)   // When the bottom open parameter button is on, the power-up state checks the second item
+        else if (this->output_info_switch_flag_ == OUTPUT_SWTICH_ON)   // When the bottom open parameter button is on, the power-up state checks the second item
         {
-            sg_start_query_data = CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH;
-            sg_start_query_data_max = CUSTOM_FUNCTION_MAX;
+            this->start_query_data_ = CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH;
+            this->start_query_data_max_ = CUSTOM_FUNCTION_MAX;
         }
-        s_power_on_status++;  // There are a total of four inspections
+        this->power_on_status_++;  // There are a total of four inspections
     }
     else
     {
-        sg_start_query_data = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
-        sg_start_query_data_max = STANDARD_FUNCTION_QUERY_KEEPAWAY_STATUS;
+        this->start_query_data_ = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
+        this->start_query_data_max_ = STANDARD_FUNCTION_QUERY_KEEPAWAY_STATUS;
     }
 }
 
@@ -134,27 +208,37 @@ void mr24hpc1Component::loop() {
     while (this->available())
     {
         this->read_byte(&byte);
-        this->R24_split_data_frame(byte);  // split data frame
+        this->feed(byte);  // split data frame
     }
+    this->flush_coalesced_frames();  // Presence and motion frames were dispatched while draining, telemetry comes last
+
+    this->check_link();
+
+#ifdef USE_MR24HPC1_STREAM
+    this->process_stream();
+#endif
+
+    // Flush queued setting writes, no faster than the configured write spacing
+    this->process_write_slots();
 
-    // !s_output_info_switch_flag = !OUTPUT_SWITCH_INIT = !0 = 1  (Power-up check first item - check if the underlying open parameters are turned on)
-    if (!s_output_info_switch_flag && sg_start_query_data == CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH)
+    // !this->output_info_switch_flag_ = !OUTPUT_SWITCH_INIT = !0 = 1  (Power-up check first item - check if the underlying open parameters are turned on)
+    if (!this->output_info_switch_flag_ && this->start_query_data_ == CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH)
     {
         // Check if the button for the underlying open parameter is on, if so
-        this->get_radar_output_information_switch();  // This function in conjunction with R24_split_data_frame changes the state of the s_output_info_switch_flag, ON or OFF.
-        sg_start_query_data++;    // now: sg_start_query_data = CUSTOM_FUNCTION_QUERY_PRESENCE_OF_DETECTION_RANGE  sg_start_query_data_max = CUSTOM_FUNCTION_MAX
+        this->get_radar_output_information_switch();  // This function in conjunction with the frame parser changes the state of the this->output_info_switch_flag_, ON or OFF.
+        this->start_query_data_++;    // now: this->start_query_data_ = CUSTOM_FUNCTION_QUERY_PRESENCE_OF_DETECTION_RANGE  this->start_query_data_max_ = CUSTOM_FUNCTION_MAX
     }
-    // When the switch for the underlying open parameter is off, the value of sg_start_query_data should be within limits
-    if ((s_output_info_switch_flag == OUTPUT_SWTICH_OFF) && (sg_start_query_data <= sg_start_query_data_max) && (sg_start_query_data >= STANDARD_FUNCTION_QUERY_PRODUCT_MODE))
+    // When the switch for the underlying open parameter is off, the value of this->start_query_data_ should be within limits
+    if ((this->output_info_switch_flag_ == OUTPUT_SWTICH_OFF) && (this->start_query_data_ <= this->start_query_data_max_) && (this->start_query_data_ >= STANDARD_FUNCTION_QUERY_PRODUCT_MODE))
     {
-        switch (sg_start_query_data)
+        switch (this->start_query_data_)
         {
             case STANDARD_FUNCTION_QUERY_PRODUCT_MODE:
                 if (strlen(this->c_product_mode) > 0)
                 {
                     this->product_model_text_sensor_->publish_state(this->c_product_mode);  // Release Product Model
                 }
-                else
+                else if (this->capabilities_.is_supported(CAPABILITY_PRODUCT_MODE))
                 {
                     this->get_product_mode();  // Check Product Model
                 }
@@ -164,7 +248,7 @@ void mr24hpc1Component::loop() {
                 {
                     this->product_id_text_sensor_->publish_state(this->c_product_id);  // Publish Product ID
                 }
-                else
+                else if (this->capabilities_.is_supported(CAPABILITY_PRODUCT_ID))
                 {
                     this->get_product_id();  // Check Product ID
                 }
@@ -190,134 +274,135 @@ void mr24hpc1Component::loop() {
                 }
                 break;
             case STANDARD_FUNCTION_QUERY_HUMAN_STATUS:
-                this->get_human_status();
+                if (this->capabilities_.is_supported(CAPABILITY_HUMAN_STATUS))
+                {
+                    this->get_human_status();
+                }
                 break;
             case STANDARD_FUNCTION_QUERY_KEEPAWAY_STATUS:
-                this->get_keep_away();
+                if (this->capabilities_.is_supported(CAPABILITY_KEEP_AWAY))
+                {
+                    this->get_keep_away();
+                }
                 break;
             case STANDARD_FUNCTION_MAX:
                 this->get_heartbeat_packet();
                 break;
         }
-        sg_start_query_data++;
+        this->start_query_data_++;
+    }
+    if (this->start_query_data_ > CUSTOM_FUNCTION_MAX) this->start_query_data_ = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
+
+    if (!this->has_pending_work())
+    {
+        this->disable_loop();   // Woken up again by the rx poll, update(), queued writes and heartbeats
     }
-    if (sg_start_query_data > CUSTOM_FUNCTION_MAX) sg_start_query_data = STANDARD_FUNCTION_QUERY_PRODUCT_MODE;
 }
 
-// split data frame
-void mr24hpc1Component::R24_split_data_frame(uint8_t value)
+// Work that needs loop() to keep running: unread bytes, a query sequence step, a heartbeat
+// waiting for its reply or writes in flight. Deadlines further away, the release of the fused
+// presence and the flush of streamed frames, are timers and do not keep loop() awake.
+bool mr24hpc1Component::has_pending_work(void)
 {
-    switch (sg_recv_data_state)
+    if (this->available())
+        return true;
+    if (!this->output_info_switch_flag_ && this->start_query_data_ == CUSTOM_FUNCTION_QUERY_RADAR_OUITPUT_INFORMATION_SWITCH)
+        return true;
+    if (this->output_info_switch_flag_ == OUTPUT_SWTICH_OFF && this->start_query_data_ <= this->start_query_data_max_ &&
+        this->start_query_data_ >= STANDARD_FUNCTION_QUERY_PRODUCT_MODE)
+        return true;
+    if (this->heartbeat_pending_ || this->write_burst_)
+        return true;
+    for (const WriteSlot &write_slot : this->write_slots_)
     {
-        case FRAME_IDLE:                    // starting value
-            if (FRAME_HEADER1_VALUE == value)
-            {
-                sg_recv_data_state = FRAME_HEADER2;
-            }
-            break;
-        case FRAME_HEADER2:
-            if (FRAME_HEADER2_VALUE == value)
-            {
-                sg_frame_buf[0] = FRAME_HEADER1_VALUE;
-                sg_frame_buf[1] = FRAME_HEADER2_VALUE;
-                sg_recv_data_state = FRAME_CTL_WORLD;
-            }
-            else
-            {
-                sg_recv_data_state = FRAME_IDLE;
-                ESP_LOGD(TAG, "FRAME_IDLE ERROR value:%x", value);
-            }
-            break;
-        case FRAME_CTL_WORLD:
-            sg_frame_buf[2] = value;
-            sg_recv_data_state = FRAME_CMD_WORLD;
-            break;
-        case FRAME_CMD_WORLD:
-            sg_frame_buf[3] = value;
-            sg_recv_data_state = FRAME_DATA_LEN_H;
-            break;
-        case FRAME_DATA_LEN_H:
-            if (value <= 4)
-            {
-                sg_data_len = value * 256;
-                sg_frame_buf[4] = value;
-                sg_recv_data_state = FRAME_DATA_LEN_L;
-            }
-            else
-            {
-                sg_data_len = 0;
-                sg_recv_data_state = FRAME_IDLE;
-                ESP_LOGD(TAG, "FRAME_DATA_LEN_H ERROR value:%x", value);
-            }
-            break;
-        case FRAME_DATA_LEN_L:
-            sg_data_len += value;
-            if (sg_data_len > 32)
-            {
-                ESP_LOGD(TAG, "len=%d, FRAME_DATA_LEN_L ERROR value:%x", sg_data_len, value);
-                sg_data_len = 0;
-                sg_recv_data_state = FRAME_IDLE;
-            }
-            else
-            {
-                sg_frame_buf[5] = value;
-                sg_frame_len = 6;
-                sg_recv_data_state = FRAME_DATA_BYTES;
-            }
-            break;
-        case FRAME_DATA_BYTES:
-            sg_data_len -= 1;
-            sg_frame_buf[sg_frame_len++] = value;
-            if (sg_data_len <= 0)
-            {
-                sg_recv_data_state = FRAME_DATA_CRC;
-            }
-            break;
-        case FRAME_DATA_CRC:
-            sg_frame_buf[sg_frame_len++] = value;
-            sg_recv_data_state = FRAME_TAIL1;
-            break;
-        case FRAME_TAIL1:
-            if (FRAME_TAIL1_VALUE == value)
-            {
-                sg_recv_data_state = FRAME_TAIL2;
-            }
-            else
-            {
-                sg_recv_data_state = FRAME_IDLE;
-                sg_frame_len = 0;
-                sg_data_len = 0;
-                ESP_LOGD(TAG, "FRAME_TAIL1 ERROR value:%x", value);
-            }
-            break;
-        case FRAME_TAIL2:
-            if (FRAME_TAIL2_VALUE == value)
-            {
-                sg_frame_buf[sg_frame_len++] = FRAME_TAIL1_VALUE;
-                sg_frame_buf[sg_frame_len++] = FRAME_TAIL2_VALUE;
-                memcpy(sg_frame_prase_buf, sg_frame_buf, sg_frame_len);
-                if (get_frame_check_status(sg_frame_prase_buf, sg_frame_len))
-                {
-                    this->R24_parse_data_frame(sg_frame_prase_buf, sg_frame_len);
-                }
-                else
-                {
-                    ESP_LOGD(TAG, "frame check failer!");
-                }
-            }
-            else
-            {
-                ESP_LOGD(TAG, "FRAME_TAIL2 ERROR value:%x", value);
-            }
-            memset(sg_frame_prase_buf, 0, FRAME_BUF_MAX_SIZE);
-            memset(sg_frame_buf, 0, FRAME_BUF_MAX_SIZE);
-            sg_frame_len = 0;
-            sg_data_len = 0;
-            sg_recv_data_state = FRAME_IDLE;
-            break;
-        default:
-            sg_recv_data_state = FRAME_IDLE;
+        if (write_slot.dirty || write_slot.status == WRITE_STATUS_SENT)
+            return true;
     }
+    return false;
+}
+
+// Release the fused presence once its hold time has passed without new evidence. A single timer
+// per hold period: evidence arriving meanwhile only moves the deadline, checked when it fires.
+void mr24hpc1Component::schedule_fusion_release(void)
+{
+    if (this->fusion_hold_armed_ || !this->presence_fusion_.is_present())
+        return;
+    this->fusion_hold_armed_ = true;
+    this->set_timeout("fusion_hold", this->presence_fusion_.hold_remaining(millis()), [this]() {
+        this->fusion_hold_armed_ = false;
+        if (this->presence_fusion_.expire(millis()))
+        {
+            this->publish_fused_presence();
+            this->update_adaptive_stream();
+        }
+        this->schedule_fusion_release();
+    });
+}
+
+#ifdef USE_MR24HPC1_STREAM
+// Send what is due, the frames left pending are flushed by a timer once their flush interval passed.
+// The same timer paces the retries while the collector is unreachable.
+void mr24hpc1Component::process_stream(void)
+{
+    uint32_t now = millis();
+    this->streamer_.process(this->frame_ring_, now);
+    if (this->stream_flush_armed_ || !this->streamer_.has_pending(this->frame_ring_))
+        return;
+    this->stream_flush_armed_ = true;
+    this->set_timeout("stream_flush", this->streamer_.flush_delay(now), [this]() {
+        this->stream_flush_armed_ = false;
+        this->process_stream();
+    });
+}
+#endif
+
+// Frame engine hooks, see seeed_radar::FrameEngine
+void mr24hpc1Component::on_frame_start()
+{
+    this->frame_start_us_ = micros();  // Start of the receive stage
+}
+
+void mr24hpc1Component::on_frame_received()
+{
+    this->frame_complete_us_ = micros();
+}
+
+void mr24hpc1Component::on_frame(uint8_t *frame, size_t len)
+{
+    this->last_valid_frame_ms_ = millis();
+    this->frame_dispatch_us_ = micros();
+    this->frame_receive_us_ = this->frame_complete_us_ - this->frame_start_us_;
+    this->frame_parse_us_ = this->frame_dispatch_us_ - this->frame_complete_us_;
+    uint8_t control = frame[FRAME_CONTROL_WORD_INDEX];
+    uint8_t command = frame[FRAME_COMMAND_WORD_INDEX];
+    if (is_report_frame(control, command))
+    {
+        this->last_report_ms_ = this->last_valid_frame_ms_;
+        this->report_stalls_ = 0;
+    }
+    this->report_intervals_.record(control, command, this->last_valid_frame_ms_);   // Every arrival, also superseded ones
+    if (control == COALESCE_CONTROL_WORD)
+    {
+        this->process_stream_sample(frame);   // Every report, also one whose publishes get superseded
+    }
+    if (this->coalescer_.offer(frame, len, control, command))
+        return;   // Published once the UART is drained
+    if (control == COALESCE_CONTROL_WORD)
+    {
+        this->flush_coalesced_frames();   // Stream switch and setting read-backs stay ordered with the reports before them
+    }
+    this->R24_parse_data_frame(frame, len);
+}
+
+// Publish the stream reports held back while draining the UART, at most one per command
+void mr24hpc1Component::flush_coalesced_frames(void)
+{
+    this->coalescer_.flush([this](uint8_t *frame, size_t len) { this->R24_parse_data_frame(frame, len); });
+}
+
+void mr24hpc1Component::on_frame_error(const char *reason, uint8_t value)
+{
+    ESP_LOGD(TAG, "Frame %s error, value:%x", reason, value);
 }
 
 // Parses data frames related to product information
@@ -361,6 +446,7 @@ void mr24hpc1Component::R24_frame_parse_product_Information(uint8_t *data)
             memcpy(this->c_hardware_model, &data[FRAME_DATA_INDEX], product_len);
             this->hardware_model_text_sensor_->publish_state(this->c_hardware_model);
             ESP_LOGD(TAG, "Reply: get hardware_model :%s", this->c_hardware_model);
+            this->load_capabilities();
         }
         else
         {
@@ -376,6 +462,7 @@ void mr24hpc1Component::R24_frame_parse_product_Information(uint8_t *data)
             memset(this->c_firmware_version, 0, PRODUCT_BUF_MAX_SIZE);
             memcpy(this->c_firmware_version, &data[FRAME_DATA_INDEX], product_len);
             this->firware_version_text_sensor_->publish_state(this->c_firmware_version);
+            this->load_capabilities();
         }
         else
         {
@@ -389,15 +476,15 @@ void mr24hpc1Component::R24_frame_parse_open_underlying_information(uint8_t *dat
 {
     if (data[FRAME_COMMAND_WORD_INDEX] == 0x00)
     {
-        this->underly_open_function_switch_->publish_state(data[FRAME_DATA_INDEX]);  // Underlying Open Parameter Switch Status Updates
-        if (data[FRAME_DATA_INDEX])
+        uint8_t switch_flag = data[FRAME_DATA_INDEX] ? OUTPUT_SWTICH_ON : OUTPUT_SWTICH_OFF;
+        if (this->output_info_switch_flag_ != OUTPUT_SWITCH_INIT && this->output_info_switch_flag_ != switch_flag)
         {
-            s_output_info_switch_flag = OUTPUT_SWTICH_ON;
-        }
-        else
-        {
-            s_output_info_switch_flag = OUTPUT_SWTICH_OFF;
+            this->clear_underlying_open_entities();  // The radar has switched report streams, the old values are stale
+            this->report_intervals_.reset();          // and so are the report rates
         }
+        this->output_info_switch_flag_ = switch_flag;
+        this->underly_open_function_switch_->publish_state(data[FRAME_DATA_INDEX]);  // Underlying Open Parameter Switch Status Updates
+        this->confirm_write(WRITE_SLOT_UNDERLYING_OPEN, data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x01)
     {
@@ -412,7 +499,10 @@ void mr24hpc1Component::R24_frame_parse_open_underlying_information(uint8_t *dat
         // none:0x00  close_to:0x01  far_away:0x02
         if (data[FRAME_DATA_INDEX] < 3 && data[FRAME_DATA_INDEX] >= 0)
         {
+            uint32_t publish_start_us = micros();
             this->keep_away_text_sensor_->publish_state(s_keep_away_str[data[FRAME_DATA_INDEX]]);
+            this->record_publish_latency(publish_start_us);
+            this->log_event(EVENT_KEEP_AWAY, data[FRAME_DATA_INDEX]);
         }
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x07)
@@ -470,47 +560,65 @@ void mr24hpc1Component::R24_frame_parse_open_underlying_information(uint8_t *dat
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x80)
     {
-        if (data[FRAME_DATA_INDEX])
+        uint8_t switch_flag = data[FRAME_DATA_INDEX] ? OUTPUT_SWTICH_ON : OUTPUT_SWTICH_OFF;
+        if (this->output_info_switch_flag_ != OUTPUT_SWITCH_INIT && this->output_info_switch_flag_ != switch_flag)
         {
-            s_output_info_switch_flag = OUTPUT_SWTICH_ON;
-        }
-        else
-        {
-            s_output_info_switch_flag = OUTPUT_SWTICH_OFF;
+            this->clear_underlying_open_entities();
+            this->report_intervals_.reset();
         }
+        this->output_info_switch_flag_ = switch_flag;
         this->underly_open_function_switch_->publish_state(data[FRAME_DATA_INDEX]);
+        this->confirm_write(WRITE_SLOT_UNDERLYING_OPEN, data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x81) {
         this->custom_spatial_static_value_sensor_->publish_state(data[FRAME_DATA_INDEX]);
+        this->underlying_frame_.static_energy = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x82) {
         this->custom_spatial_motion_value_sensor_->publish_state(data[FRAME_DATA_INDEX]);
+        this->underlying_frame_.motion_energy = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x83)
     {
         this->custom_presence_of_detection_sensor_->publish_state(s_presence_of_detection_range_str[data[FRAME_DATA_INDEX]]);
+        this->underlying_frame_.presence_distance = data[FRAME_DATA_INDEX];  // Range index, also in 0.5 m steps
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x84) { 
         this->custom_motion_distance_sensor_->publish_state(data[FRAME_DATA_INDEX] * 0.5f);
+        this->underlying_frame_.motion_distance = data[FRAME_DATA_INDEX];
+        this->process_target_tracker();
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x85) {  
         this->custom_motion_speed_sensor_->publish_state((data[FRAME_DATA_INDEX] - 10) * 0.5f);
+        this->underlying_frame_.motion_speed = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x86)
     {
+        uint32_t publish_start_us = micros();
         this->keep_away_text_sensor_->publish_state(s_keep_away_str[data[FRAME_DATA_INDEX]]);
+        this->record_publish_latency(publish_start_us);
+        this->log_event(EVENT_KEEP_AWAY, data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x87)
     {
         this->movementSigns_sensor_->publish_state(data[FRAME_DATA_INDEX]);
+        this->underlying_frame_.movement_signs = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x88)
     {
         // id(custom_judgment_threshold_exists).publish_state(data[FRAME_DATA_INDEX]);
+        this->confirm_write(WRITE_SLOT_EXISTENCE_THRESHOLD, data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x89)
     {
         // id(custom_motion_amplitude_trigger_threshold).publish_state(data[FRAME_DATA_INDEX]);
+        this->confirm_write(WRITE_SLOT_MOTION_THRESHOLD, data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x8a)
     {
@@ -558,13 +666,37 @@ void mr24hpc1Component::R24_frame_parse_open_underlying_information(uint8_t *dat
 
 void mr24hpc1Component::R24_parse_data_frame(uint8_t *data, uint8_t len)
 {
+    this->capability_answered(data[FRAME_CONTROL_WORD_INDEX], data[FRAME_COMMAND_WORD_INDEX]);
     switch (data[FRAME_CONTROL_WORD_INDEX])
     {
         case 0x01:
         {
             if (data[FRAME_COMMAND_WORD_INDEX] == 0x01)
             {
-                sg_heartbeat_flag = 0;
+                if (this->heartbeat_pending_)
+                {
+                    uint32_t rtt = millis() - this->heartbeat_sent_ms_;
+                    this->heartbeat_pending_ = false;
+                    if (this->heartbeat_rtt_sensor_ != nullptr)
+                    {
+                        this->heartbeat_rtt_sensor_->publish_state(rtt);
+                    }
+                }
+                if (this->recovery_step_ != LINK_RECOVERY_NONE)
+                {
+                    ESP_LOGI(TAG, "Radar link recovered after %u missed heartbeats", this->heartbeat_misses_);
+                    this->restore_configuration("heartbeat gap");   // The radar may have restarted meanwhile
+                }
+                this->recovery_step_ = LINK_RECOVERY_NONE;
+                if (this->heartbeat_misses_ != 0)
+                {
+                    this->heartbeat_misses_ = 0;
+                    if (this->heartbeat_misses_sensor_ != nullptr)
+                    {
+                        this->heartbeat_misses_sensor_->publish_state(0);
+                    }
+                }
+                this->publish_link_state(true);
             }
             else if (data[FRAME_COMMAND_WORD_INDEX] == 0x02)
             {
@@ -603,6 +735,10 @@ void mr24hpc1Component::R24_frame_parse_work_status(uint8_t *data)
     if (data[FRAME_COMMAND_WORD_INDEX] == 0x01)
     {
         ESP_LOGD(TAG, "Reply: get radar init status 0x%02X", data[FRAME_DATA_INDEX]);
+        if (data[FRAME_DATA_INDEX] == 0x01)   // Sent by the radar once it has (re)started
+        {
+            this->restore_configuration("radar initialized");
+        }
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x07)
     {
@@ -631,9 +767,11 @@ void mr24hpc1Component::R24_frame_parse_work_status(uint8_t *data)
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x87)
     {
-        if (this->scene_mode_select_->has_index(data[FRAME_DATA_INDEX] - 1))
+        // Living Room:0x01  Bedroom:0x02  Washroom:0x03  Area Detection:0x04, same order as the select options
+        if (this->scene_mode_select_->has_index(data[FRAME_DATA_INDEX]))
         {
-            this->scene_mode_select_->publish_state(s_scene_str[data[FRAME_DATA_INDEX] - 1]);
+            this->scene_mode_select_->publish_state(s_scene_str[data[FRAME_DATA_INDEX]]);
+            this->confirm_write(WRITE_SLOT_SCENE_MODE, data[FRAME_DATA_INDEX]);
         }
         else
         {
@@ -659,18 +797,26 @@ void mr24hpc1Component::R24_frame_parse_human_information(uint8_t *data)
 {
     if (data[FRAME_COMMAND_WORD_INDEX] == 0x01)
     {
+        uint32_t publish_start_us = micros();
         this->someoneExists_binary_sensor_->publish_state(s_someoneExists_str[data[FRAME_DATA_INDEX]]);
+        this->record_publish_latency(publish_start_us);
+        this->process_radar_presence(data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x02)
     {
         if (data[FRAME_DATA_INDEX] < 3 && data[FRAME_DATA_INDEX] >= 0)
         {
+            uint32_t publish_start_us = micros();
             this->motion_status_text_sensor_->publish_state(s_motion_status_str[data[FRAME_DATA_INDEX]]);
+            this->record_publish_latency(publish_start_us);
+            this->process_motion_status(data[FRAME_DATA_INDEX]);
         }
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x03)
     {
         this->movementSigns_sensor_->publish_state(data[FRAME_DATA_INDEX]);
+        this->underlying_frame_.movement_signs = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x0A)
     {
@@ -685,23 +831,34 @@ void mr24hpc1Component::R24_frame_parse_human_information(uint8_t *data)
         // none:0x00  close_to:0x01  far_away:0x02
         if (data[FRAME_DATA_INDEX] < 3 && data[FRAME_DATA_INDEX] >= 0)
         {
+            uint32_t publish_start_us = micros();
             this->keep_away_text_sensor_->publish_state(s_keep_away_str[data[FRAME_DATA_INDEX]]);
+            this->record_publish_latency(publish_start_us);
+            this->log_event(EVENT_KEEP_AWAY, data[FRAME_DATA_INDEX]);
         }
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x81)
     {
+        uint32_t publish_start_us = micros();
         this->someoneExists_binary_sensor_->publish_state(s_someoneExists_str[data[FRAME_DATA_INDEX]]);
+        this->record_publish_latency(publish_start_us);
+        this->process_radar_presence(data[FRAME_DATA_INDEX]);
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x82)
     {
         if (data[FRAME_DATA_INDEX] < 3 && data[FRAME_DATA_INDEX] >= 0)
         {
+            uint32_t publish_start_us = micros();
             this->motion_status_text_sensor_->publish_state(s_motion_status_str[data[FRAME_DATA_INDEX]]);
+            this->record_publish_latency(publish_start_us);
+            this->process_motion_status(data[FRAME_DATA_INDEX]);
         }
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x83)
     {
         this->movementSigns_sensor_->publish_state(data[FRAME_DATA_INDEX]);
+        this->underlying_frame_.movement_signs = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
     }
     else if (data[FRAME_COMMAND_WORD_INDEX] == 0x8A)
     {
@@ -716,7 +873,10 @@ void mr24hpc1Component::R24_frame_parse_human_information(uint8_t *data)
         // none:0x00  close_to:0x01  far_away:0x02
         if (data[FRAME_DATA_INDEX] < 3 && data[FRAME_DATA_INDEX] >= 0)
         {
+            uint32_t publish_start_us = micros();
             this->keep_away_text_sensor_->publish_state(s_keep_away_str[data[FRAME_DATA_INDEX]]);
+            this->record_publish_latency(publish_start_us);
+            this->log_event(EVENT_KEEP_AWAY, data[FRAME_DATA_INDEX]);
         }
     }
     else
@@ -725,6 +885,437 @@ void mr24hpc1Component::R24_frame_parse_human_information(uint8_t *data)
     }
 }
 
+// Every stream report as it arrives, before the coalescer can supersede its entity publishes: the frame
+// ring and every consumer that needs each sample. R24_frame_parse_open_underlying_information publishes.
+void mr24hpc1Component::process_stream_sample(const uint8_t *data)
+{
+    if (data[FRAME_COMMAND_WORD_INDEX] == 0x01)
+    {
+        this->underlying_frame_.static_energy = data[FRAME_DATA_INDEX];
+        this->underlying_frame_.presence_distance = data[FRAME_DATA_INDEX + 1];
+        this->underlying_frame_.motion_energy = data[FRAME_DATA_INDEX + 2];
+        this->underlying_frame_.motion_distance = data[FRAME_DATA_INDEX + 3];
+        this->underlying_frame_.motion_speed = data[FRAME_DATA_INDEX + 4];
+#ifdef USE_MR24HPC1_FRAME_RING
+        this->frame_ring_.push(this->underlying_frame_, millis());   // One record per complete report
+#endif
+#ifdef USE_MR24HPC1_WEB
+        this->web_handler_->publish(*this->frame_ring_.get(this->frame_ring_.next_seq() - 1));
+#endif
+        this->process_calibration_sample();
+        this->process_target_tracker();
+        this->process_activity();
+        this->process_underlying_open_frame();
+    }
+    else if (data[FRAME_COMMAND_WORD_INDEX] == 0x07)
+    {
+        this->underlying_frame_.movement_signs = data[FRAME_DATA_INDEX];
+        this->process_underlying_open_frame();
+    }
+}
+
+// Called whenever a field of the underlying open stream changed, everything in here is O(1)
+void mr24hpc1Component::process_underlying_open_frame(void)
+{
+    if (this->fused_presence_binary_sensor_ != nullptr)
+    {
+        if (this->presence_fusion_.feed(this->underlying_frame_, millis()))
+        {
+            this->publish_fused_presence();
+        }
+        this->schedule_fusion_release();
+    }
+    if (this->zone_lut_size_ > 0)
+    {
+        this->process_zones();
+    }
+    this->underlying_open_callback_.call(this->underlying_frame_);
+}
+
+// Sample the energy of an empty room for the given time, then derive and write the radar thresholds
+void mr24hpc1Component::start_calibration(uint32_t duration, uint8_t margin)
+{
+    if (this->calibrating_)
+    {
+        ESP_LOGW(TAG, "Calibration is already running");
+        return;
+    }
+    if (!this->presence_reported_)
+    {
+        ESP_LOGW(TAG, "Calibration needs an empty room, the radar has not reported presence yet");
+        return;
+    }
+    if (this->radar_present_ || this->motion_active_)
+    {
+        ESP_LOGW(TAG, "Calibration needs an empty room, the radar reports someone present");
+        return;
+    }
+    ESP_LOGI(TAG, "Calibrating the noise floor for %" PRIu32 " ms, keep the room empty", duration);
+    this->static_noise_.reset();
+    this->motion_noise_.reset();
+    this->calibration_margin_ = margin;
+    this->calibrating_ = true;
+    // The energy values are only reported by the underlying open stream
+    this->calibration_stream_on_ = this->output_info_switch_flag_ != OUTPUT_SWTICH_ON;
+    if (this->calibration_stream_on_)
+    {
+        this->queue_write(WRITE_SLOT_UNDERLYING_OPEN, 0x01);
+    }
+    this->set_timeout("calibration", duration, [this]() { this->finish_calibration(); });
+}
+
+void mr24hpc1Component::process_calibration_sample(void)
+{
+    if (!this->calibrating_)
+        return;
+    this->static_noise_.add(this->underlying_frame_.static_energy);
+    this->motion_noise_.add(this->underlying_frame_.motion_energy);
+}
+
+void mr24hpc1Component::finish_calibration(void)
+{
+    uint32_t samples = this->static_noise_.count();
+    this->stop_calibration();
+    if (samples < CALIBRATION_MIN_SAMPLES)
+    {
+        ESP_LOGW(TAG, "Calibration failed, only %" PRIu32 " underlying open reports were received", samples);
+        return;
+    }
+    CalibrationResult result;
+    result.existence_threshold = this->static_noise_.threshold(CALIBRATION_SIGMAS, this->calibration_margin_, ENERGY_MAX);
+    result.motion_threshold = this->motion_noise_.threshold(CALIBRATION_SIGMAS, this->calibration_margin_, ENERGY_MAX);
+    ESP_LOGI(TAG, "Calibrated over %" PRIu32 " reports: static energy %.1f +- %.1f (max %u), motion energy %.1f +- %.1f (max %u)",
+             samples, this->static_noise_.mean(), this->static_noise_.stddev(), this->static_noise_.max(),
+             this->motion_noise_.mean(), this->motion_noise_.stddev(), this->motion_noise_.max());
+    ESP_LOGI(TAG, "New thresholds: existence %u, motion %u", result.existence_threshold, result.motion_threshold);
+    this->apply_calibration(result);
+    this->calibration_pref_.save(&result);
+}
+
+void mr24hpc1Component::stop_calibration(void)
+{
+    this->cancel_timeout("calibration");
+    this->calibrating_ = false;
+    if (this->calibration_stream_on_)
+    {
+        this->calibration_stream_on_ = false;
+        this->queue_write(WRITE_SLOT_UNDERLYING_OPEN, 0x00);
+    }
+}
+
+void mr24hpc1Component::apply_calibration(const CalibrationResult &result)
+{
+    this->queue_write(WRITE_SLOT_EXISTENCE_THRESHOLD, result.existence_threshold);
+    this->queue_write(WRITE_SLOT_MOTION_THRESHOLD, result.motion_threshold);
+}
+
+// Append a transition to the event log, repeated reports of the same state are dropped
+void mr24hpc1Component::log_event(uint8_t type, uint8_t value)
+{
+#ifdef USE_MR24HPC1_EVENT_LOG
+    if (this->last_event_value_[type] == value)
+        return;
+    this->last_event_value_[type] = value;
+#ifdef USE_TIME
+    if (this->time_ != nullptr)
+    {
+        ESPTime now = this->time_->now();
+        if (now.is_valid())
+        {
+            this->event_log_.append(now.timestamp, type, value);
+            return;
+        }
+    }
+#endif
+    this->event_log_.append(millis() / 1000, type | EVENT_FLAG_UPTIME, value);
+#endif
+}
+
+void mr24hpc1Component::dump_event_log(void)
+{
+#ifdef USE_MR24HPC1_EVENT_LOG
+    // Replayed oldest first, to the log and to the on_record automations
+    this->event_log_.read([this](const EventRecord &record) {
+        ESP_LOGI(TAG, "Event %s %u at %s%" PRIu32, event_type_to_str(record.type), record.value,
+                 (record.type & EVENT_FLAG_UPTIME) ? "uptime " : "", (uint32_t) record.timestamp);
+        this->event_log_record_callback_.call(record);
+    });
+#else
+    ESP_LOGW(TAG, "The event log is not configured");
+#endif
+}
+
+// Classify every complete underlying open report, publish only when the confirmed activity changes
+void mr24hpc1Component::process_activity(void)
+{
+    if (this->activity_text_sensor_ != nullptr && this->activity_classifier_.feed(this->underlying_frame_))
+    {
+        this->publish_activity();
+    }
+}
+
+void mr24hpc1Component::publish_activity(void)
+{
+    uint8_t activity = this->activity_classifier_.get_activity();
+    this->activity_text_sensor_->publish_state(activity == ACTIVITY_UNKNOWN ? "" : s_activity_str[activity]);
+}
+
+// Feed the motion target tracker with a new motion distance, publish only what changed at sensor resolution
+void mr24hpc1Component::process_target_tracker(void)
+{
+    if (!this->tracker_enabled_)
+        return;
+    if (this->target_tracker_.feed(this->underlying_frame_.motion_distance, this->underlying_frame_.motion_speed, millis()))
+    {
+        // The tracker only notices a lost target on its next report, which does not come once the stream stops
+        this->set_timeout("tracker_lost", TRACKER_LOST_MS, [this]() { this->reset_target_tracker(); });
+    }
+    else
+    {
+        this->cancel_timeout("tracker_lost");
+    }
+    this->publish_target_tracker();
+}
+
+void mr24hpc1Component::reset_target_tracker(void)
+{
+    this->cancel_timeout("tracker_lost");
+    this->target_tracker_.reset();
+    this->publish_target_tracker();
+}
+
+void mr24hpc1Component::publish_target_tracker(void)
+{
+    bool tracking = this->target_tracker_.is_tracking();
+    int32_t distance_cm = tracking ? this->target_tracker_.distance_mm() / 10 : -1;
+    int32_t velocity_cm_s = tracking ? this->target_tracker_.velocity_mm_s() / 10 : 0;
+    int32_t arrival_ms = this->target_tracker_.arrival_ms();
+    int32_t arrival_ds = arrival_ms < 0 ? -1 : arrival_ms / 100;
+#ifdef USE_SENSOR
+    if (distance_cm != this->tracked_distance_cm_ && this->tracked_distance_sensor_ != nullptr)
+    {
+        this->tracked_distance_sensor_->publish_state(tracking ? distance_cm / 100.0f : NAN);
+    }
+    if ((velocity_cm_s != this->tracked_velocity_cm_s_ || distance_cm != this->tracked_distance_cm_) &&
+        this->tracked_velocity_sensor_ != nullptr)
+    {
+        this->tracked_velocity_sensor_->publish_state(tracking ? velocity_cm_s / 100.0f : NAN);
+    }
+    if (arrival_ds != this->arrival_ds_ && this->arrival_time_sensor_ != nullptr)
+    {
+        this->arrival_time_sensor_->publish_state(arrival_ds < 0 ? NAN : arrival_ds / 10.0f);
+    }
+#endif
+    this->tracked_distance_cm_ = distance_cm;
+    this->tracked_velocity_cm_s_ = velocity_cm_s;
+    this->arrival_ds_ = arrival_ds;
+}
+
+// Zone occupancy in constant time: stay in the zones the distance still keeps, enter the ones it hits,
+// then publish only the zones whose state flipped
+void mr24hpc1Component::process_zones(void)
+{
+    // A moving target wins over the static one, raw 0 on both means nobody is detected
+    uint8_t distance = this->underlying_frame_.motion_distance ? this->underlying_frame_.motion_distance : this->underlying_frame_.presence_distance;
+    uint32_t enter = distance < this->zone_lut_size_ ? this->zone_enter_lut_[distance] : 0;
+    uint32_t stay = distance < this->zone_lut_size_ ? this->zone_stay_lut_[distance] : 0;
+    uint32_t mask = (this->zone_mask_ & stay) | enter;
+    uint32_t changed = mask ^ this->zone_mask_;
+    this->zone_mask_ = mask;
+#ifdef USE_BINARY_SENSOR
+    while (changed)
+    {
+        uint8_t zone = __builtin_ctz(changed);
+        changed &= changed - 1;
+        if (zone < this->zone_binary_sensors_.size())
+        {
+            this->zone_binary_sensors_[zone]->publish_state(mask & (1u << zone));
+        }
+    }
+#endif
+}
+
+void mr24hpc1Component::set_zone_lookup(const uint32_t *enter_lut, const uint32_t *stay_lut, uint8_t size)
+{
+    this->zone_enter_lut_ = enter_lut;
+    this->zone_stay_lut_ = stay_lut;
+    this->zone_lut_size_ = size;
+}
+
+// Called on every someoneExists report of the radar
+void mr24hpc1Component::process_radar_presence(bool present)
+{
+    if (this->fused_presence_binary_sensor_ != nullptr)
+    {
+        if (this->presence_fusion_.feed_radar_presence(present, millis()))
+        {
+            this->publish_fused_presence();
+        }
+        this->schedule_fusion_release();
+    }
+    this->radar_present_ = present;
+    this->presence_reported_ = true;
+    if (!present && this->activity_text_sensor_ != nullptr && this->activity_classifier_.set_empty())
+    {
+        this->publish_activity();
+    }
+    this->log_event(EVENT_PRESENCE, present);
+    if (present && this->calibrating_)
+    {
+        ESP_LOGW(TAG, "Calibration aborted, the radar reports someone in the room");
+        this->stop_calibration();
+    }
+    this->update_adaptive_stream();
+    this->presence_callback_.call(present);
+}
+
+// Called on every motion status report of the radar, none:0x00 motionless:0x01 active:0x02
+void mr24hpc1Component::process_motion_status(uint8_t status)
+{
+    this->motion_active_ = (status == 0x02);
+    this->log_event(EVENT_MOTION_STATUS, status);
+    if (this->motion_active_ && this->calibrating_)
+    {
+        ESP_LOGW(TAG, "Calibration aborted, the radar reports motion in the room");
+        this->stop_calibration();
+    }
+    this->update_adaptive_stream();
+}
+
+// In auto mode switch the underlying open report stream on as soon as the room is occupied and
+// off once it has been unmanned for the hold time. Toggles closer than the minimum toggle
+// interval are deferred, update() retries them every report interval.
+void mr24hpc1Component::update_adaptive_stream(void)
+{
+    if (!this->adaptive_stream_ || this->calibrating_ || this->output_info_switch_flag_ == OUTPUT_SWITCH_INIT)
+        return;
+    uint32_t now = millis();
+    bool occupied = this->radar_present_ || this->motion_active_ ||
+                    (this->fused_presence_binary_sensor_ != nullptr && this->presence_fusion_.is_present());
+    if (occupied)
+    {
+        this->last_occupied_ms_ = now;
+    }
+    const WriteSlot &write_slot = this->write_slots_[WRITE_SLOT_UNDERLYING_OPEN];
+    bool stream_on = (write_slot.status == WRITE_STATUS_PENDING || write_slot.status == WRITE_STATUS_SENT)
+                         ? write_slot.value == 0x01
+                         : this->output_info_switch_flag_ == OUTPUT_SWTICH_ON;
+    bool want_on = occupied || (stream_on && (now - this->last_occupied_ms_) < this->unmanned_hold_time_);
+    if (want_on == stream_on)
+        return;
+    if (this->stream_toggled_ && (now - this->last_stream_toggle_ms_) < this->min_toggle_interval_)
+        return;
+    ESP_LOGD(TAG, "Room %s, switching the underlying open stream %s", occupied ? "occupied" : "unmanned", want_on ? "on" : "off");
+    this->last_stream_toggle_ms_ = now;
+    this->stream_toggled_ = true;
+    this->queue_write(WRITE_SLOT_UNDERLYING_OPEN, want_on ? 0x01 : 0x00);
+}
+
+void mr24hpc1Component::publish_fused_presence(void)
+{
+    if (this->fused_presence_binary_sensor_ != nullptr)
+    {
+        this->fused_presence_binary_sensor_->publish_state(this->presence_fusion_.is_present());
+    }
+}
+
+void mr24hpc1Component::configure_presence_fusion(uint8_t motion_threshold, uint8_t static_threshold, uint8_t movement_threshold,
+                                                  uint8_t hysteresis, uint8_t max_distance, uint32_t hold_time)
+{
+    this->presence_fusion_.set_motion_threshold(motion_threshold);
+    this->presence_fusion_.set_static_threshold(static_threshold);
+    this->presence_fusion_.set_movement_threshold(movement_threshold);
+    this->presence_fusion_.set_hysteresis(hysteresis);
+    this->presence_fusion_.set_max_distance(max_distance);
+    this->presence_fusion_.set_hold_time(hold_time);
+}
+
+// Record the stages of a frame that ended in a presence, motion status or keep away publish.
+// Bytes waiting in the UART buffer before loop() drains them are not visible here: that is up to
+// one rx_poll_interval while loop() sleeps. A long receive stage means the frame was split across
+// loop iterations.
+void mr24hpc1Component::record_publish_latency(uint32_t publish_start_us)
+{
+    uint32_t now = micros();
+    this->latency_[LATENCY_STAGE_RECEIVE].record(this->frame_receive_us_);
+    this->latency_[LATENCY_STAGE_PARSE].record(this->frame_parse_us_);
+    this->latency_[LATENCY_STAGE_DISPATCH].record(publish_start_us - this->frame_dispatch_us_);
+    this->latency_[LATENCY_STAGE_PUBLISH].record(now - publish_start_us);
+    this->latency_[LATENCY_STAGE_TOTAL].record(now - this->frame_start_us_);
+}
+
+// Watch the periodic reports: the underlying open stream 0x08/0x01 and the 0x80 human information reports.
+// The first stalled or slowed report is published, a change is logged once.
+void mr24hpc1Component::check_report_intervals(void)
+{
+    uint32_t now = millis();
+    uint16_t problem_key = 0;
+    uint8_t problem = REPORT_OK;
+    for (const ReportInterval &entry : this->report_intervals_)
+    {
+        if (entry.key == 0)
+            continue;
+        ESP_LOGV(TAG, "Report 0x%02X/0x%02X: %" PRIu32 " frames, mean %" PRIu32 " ms, min %" PRIu32 " ms, max %" PRIu32 " ms, jitter %" PRIu32 " ms",
+                 entry.key >> 8, entry.key & 0xFF, entry.count, entry.mean_ms(), entry.min_ms, entry.max_ms, entry.jitter_ms());
+        if (entry.key != 0x0801 && (entry.key >> 8) != 0x80)
+            continue;
+        uint8_t state = entry.check(now);
+        if (state > problem)
+        {
+            problem = state;
+            problem_key = entry.key;
+        }
+    }
+    if (problem == this->report_problem_ && problem_key == this->report_problem_key_)
+        return;
+    this->report_problem_ = problem;
+    this->report_problem_key_ = problem_key;
+    char status[32];
+    if (problem == REPORT_OK)
+    {
+        ESP_LOGI(TAG, "Radar reports arrive at their usual rate again");
+        snprintf(status, sizeof(status), "OK");
+    }
+    else
+    {
+        snprintf(status, sizeof(status), "0x%02X/0x%02X %s", problem_key >> 8, problem_key & 0xFF,
+                 problem == REPORT_STALLED ? "stalled" : "slow");
+        ESP_LOGW(TAG, "Report %s", status);
+    }
+    if (this->report_status_text_sensor_ != nullptr)
+    {
+        this->report_status_text_sensor_->publish_state(status);
+    }
+}
+
+// Publish the 95th percentile of every latency stage over the last update interval, in microseconds.
+// Every stage is recorded for the same frames, an interval without any publishes nothing.
+void mr24hpc1Component::publish_latency(void)
+{
+    if (this->latency_[LATENCY_STAGE_TOTAL].count() == 0)
+        return;
+    ESP_LOGD(TAG, "Presence latency p50 %" PRIu32 " us, p95 %" PRIu32 " us, max %" PRIu32 " us over %" PRIu32 " frames",
+             this->latency_[LATENCY_STAGE_TOTAL].percentile(50), this->latency_[LATENCY_STAGE_TOTAL].percentile(95),
+             this->latency_[LATENCY_STAGE_TOTAL].max(), this->latency_[LATENCY_STAGE_TOTAL].count());
+#ifdef USE_SENSOR
+    sensor::Sensor *latency_sensors[LATENCY_STAGE_MAX] = {
+        this->receive_latency_sensor_, this->parse_latency_sensor_, this->dispatch_latency_sensor_,
+        this->publish_latency_sensor_, this->presence_latency_sensor_,
+    };
+    for (uint8_t i = 0; i < LATENCY_STAGE_MAX; i++)
+    {
+        if (latency_sensors[i] != nullptr)
+        {
+            latency_sensors[i]->publish_state(this->latency_[i].percentile(95));
+        }
+    }
+#endif
+    for (LatencyHistogram &histogram : this->latency_)
+    {
+        histogram.reset();
+    }
+}
+
 // Sending data frames
 void mr24hpc1Component::send_query(uint8_t *query, size_t string_length)
 {
@@ -736,97 +1327,554 @@ void mr24hpc1Component::send_query(uint8_t *query, size_t string_length)
     show_frame_data(query, i);
 }
 
-// Send Heartbeat Packet Command
-void mr24hpc1Component::get_heartbeat_packet(void)
+// Sending a single data byte frame
+void mr24hpc1Component::send_frame(uint8_t control, uint8_t command, uint8_t value)
 {
-    uint8_t send_data_len = 10;
-    uint8_t send_data[10] = {0x53, 0x59, 0x01, 0x01, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
+    uint8_t send_data[1 + seeed_radar::FRAME_OVERHEAD];
+    size_t send_data_len = seeed_radar::build_frame(send_data, control, command, &value, 1);
     this->send_query(send_data, send_data_len);
+    this->capability_sent(control, command);
+}
+
+// Look up what this firmware revision answered before, or start probing it
+void mr24hpc1Component::load_capabilities(void)
+{
+    if (this->capabilities_keyed_ || strlen(this->c_firmware_version) == 0 || strlen(this->c_hardware_model) == 0)
+        return;
+    uint32_t hash = fnv1_hash(std::string(this->c_firmware_version) + "/" + this->c_hardware_model) ^ this->preference_hash_;
+    this->capability_pref_ = global_preferences->make_preference<CapabilityBitmap>(hash, true);
+    this->capabilities_keyed_ = true;
+    CapabilityBitmap bitmap;
+    if (this->capability_pref_.load(&bitmap))
+    {
+        this->capabilities_.load(bitmap);
+        ESP_LOGI(TAG, "Firmware %s (%s) capabilities: 0x%02" PRIX32 " supported of 0x%02" PRIX32 " probed",
+                 this->c_firmware_version, this->c_hardware_model, bitmap.supported, bitmap.probed);
+    }
+    else
+    {
+        // Keep the replies seen so far, they came from the same radar
+        ESP_LOGI(TAG, "Probing the capabilities of firmware %s (%s)", this->c_firmware_version, this->c_hardware_model);
+        if (this->capabilities_.bitmap().probed != 0)
+        {
+            this->save_capabilities();
+        }
+    }
+    this->publish_unsupported_capabilities();
+    if (this->capabilities_reprobe_)
+    {
+        this->capabilities_reprobe_ = false;
+        this->reprobe_capabilities();
+    }
+    else
+    {
+        this->schedule_capability_reprobe();
+    }
+}
+
+// Only requests on a healthy link count, a radar that is not answering at all tells nothing about its firmware
+void mr24hpc1Component::capability_sent(uint8_t control, uint8_t command)
+{
+    if (!this->capabilities_keyed_ || this->link_normal_ != 1)
+        return;
+    bool reprobing = this->capabilities_.is_reprobing(control, command);
+    if (this->capabilities_.sent(control, command))
+    {
+        ESP_LOGI(TAG, "Command 0x%02X/0x%02X not answered %u times, firmware %s does not support it", control, command,
+                 CAPABILITY_PROBE_ATTEMPTS, this->c_firmware_version);
+        if (!reprobing)
+        {
+            this->save_capabilities();   // A confirmed verdict is already in flash
+            this->publish_unsupported_capabilities();
+        }
+        this->schedule_capability_reprobe();
+    }
+}
+
+void mr24hpc1Component::capability_answered(uint8_t control, uint8_t command)
+{
+    if (this->capabilities_.answered(control, command) && this->capabilities_keyed_)
+    {
+        ESP_LOGD(TAG, "Command 0x%02X/0x%02X supported by firmware %s", control, command, this->c_firmware_version);
+        this->save_capabilities();
+    }
+}
+
+// Firmware can answer later what it did not answer during probing, e.g. a busy radar right after power-up.
+// The unsupported commands are probed again with a backoff, once the radar has been re-initialized
+// right away and the backoff starts over.
+void mr24hpc1Component::schedule_capability_reprobe(void)
+{
+    for (uint8_t i = 0; i < CAPABILITY_MAX; i++)
+    {
+        if (this->capabilities_.is_unsupported(i))
+        {
+            this->set_timeout("capability_reprobe", this->capability_reprobe_ms_, [this]() {
+                this->capability_reprobe_ms_ = std::min<uint32_t>(this->capability_reprobe_ms_ * 2, CAPABILITY_REPROBE_MAX_MS);
+                this->reprobe_capabilities();
+            });
+            return;
+        }
+    }
+}
+
+void mr24hpc1Component::reprobe_capabilities(void)
+{
+    uint32_t reprobing = this->capabilities_.reprobe();
+    if (reprobing == 0)
+        return;
+    ESP_LOGD(TAG, "Probing the unsupported capabilities 0x%02" PRIX32 " of firmware %s again", reprobing,
+             this->c_firmware_version);
+    // The settings are probed by their read-back, write the requested values again
+    bool any = false;
+    for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+    {
+        WriteSlot &write_slot = this->write_slots_[i];
+        if (!write_slot.has_target || !this->capabilities_.is_reprobing(s_write_slot_words[i][2], s_write_slot_words[i][3]))
+            continue;
+        write_slot.dirty = true;
+        write_slot.retries = 0;
+        write_slot.status = WRITE_STATUS_PENDING;
+        any = true;
+    }
+    if (any)
+    {
+        this->publish_write_status();
+    }
+    this->enable_loop();
+}
+
+// The text entities of an unsupported feature say so instead of staying empty or stale, nothing else
+// publishes to them until a reply revises the verdict
+void mr24hpc1Component::publish_unsupported_capabilities(void)
+{
+    if (this->capabilities_.is_unsupported(CAPABILITY_PRODUCT_MODE))
+    {
+        this->product_model_text_sensor_->publish_state("Unsupported");
+    }
+    if (this->capabilities_.is_unsupported(CAPABILITY_PRODUCT_ID))
+    {
+        this->product_id_text_sensor_->publish_state("Unsupported");
+    }
+    if (this->capabilities_.is_unsupported(CAPABILITY_KEEP_AWAY))
+    {
+        this->keep_away_text_sensor_->publish_state("Unsupported");
+    }
+}
+
+// At most one flash write per command and firmware revision
+void mr24hpc1Component::save_capabilities(void)
+{
+    CapabilityBitmap bitmap = this->capabilities_.bitmap();
+    this->capability_pref_.save(&bitmap);
+}
+
+// Queue a setting for the radar. Only the last requested value is written, the entity is updated once the radar reports it back
+void mr24hpc1Component::queue_write(uint8_t slot, uint8_t value)
+{
+    if (slot >= WRITE_SLOT_MAX)
+        return;
+    if (!this->capabilities_.is_supported(s_write_slot_words[slot][2], s_write_slot_words[slot][3]))
+    {
+        ESP_LOGW(TAG, "Setting %d is not supported by firmware %s", slot, this->c_firmware_version);
+        return;
+    }
+    WriteSlot &write_slot = this->write_slots_[slot];
+    if (write_slot.has_confirmed && write_slot.confirmed_value == value && write_slot.status != WRITE_STATUS_SENT)
+    {
+        write_slot.value = value;
+        write_slot.has_target = true;
+        // The radar already runs with this value, drop anything still queued
+        write_slot.dirty = false;
+        write_slot.status = WRITE_STATUS_CONFIRMED;
+        this->publish_write_slot(slot);
+    }
+    else
+    {
+        write_slot.value = value;
+        write_slot.has_target = true;
+        write_slot.dirty = true;
+        write_slot.retries = 0;
+        write_slot.status = WRITE_STATUS_PENDING;
+        this->enable_loop();
+    }
+    this->publish_write_status();
+}
+
+// Called from the parsers whenever the radar reports the current value of a setting
+void mr24hpc1Component::confirm_write(uint8_t slot, uint8_t value)
+{
+    WriteSlot &write_slot = this->write_slots_[slot];
+    write_slot.confirmed_value = value;
+    write_slot.has_confirmed = true;
+    if (!write_slot.has_target && !(slot == WRITE_SLOT_SCENE_MODE && value == 0x00))
+    {
+        // Nothing was requested yet, the setting the radar runs with becomes the snapshot
+        write_slot.value = value;
+        write_slot.has_target = true;
+    }
+    if (write_slot.status == WRITE_STATUS_SENT && write_slot.value == value)
+    {
+        write_slot.status = WRITE_STATUS_CONFIRMED;
+    }
+}
+
+// Retry unacknowledged writes and send at most one queued write per write interval
+void mr24hpc1Component::process_write_slots(void)
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+    {
+        WriteSlot &write_slot = this->write_slots_[i];
+        if (write_slot.status != WRITE_STATUS_SENT || (now - write_slot.sent_ms) < WRITE_ACK_TIMEOUT_MS)
+            continue;
+        if (write_slot.retries < WRITE_RETRY_MAX)
+        {
+            write_slot.dirty = true;
+            write_slot.status = WRITE_STATUS_PENDING;
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Write of setting %d value 0x%02X was not acknowledged by the radar", i, write_slot.value);
+            write_slot.status = WRITE_STATUS_FAILED;
+            this->publish_write_slot(i);  // Fall back to the last state the radar reported
+        }
+    }
+    if (this->write_burst_)
+    {
+        // Restore: pipeline every set frame and its read-back, the acknowledgments are checked as usual
+        this->write_burst_ = false;
+        for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+        {
+            WriteSlot &write_slot = this->write_slots_[i];
+            if (!write_slot.dirty)
+                continue;
+            this->send_frame(s_write_slot_words[i][0], s_write_slot_words[i][1], write_slot.value);
+            this->send_frame(s_write_slot_words[i][2], s_write_slot_words[i][3], 0x0F);
+            write_slot.dirty = false;
+            write_slot.status = WRITE_STATUS_SENT;
+            write_slot.sent_ms = now;
+            write_slot.retries++;
+        }
+        this->last_write_ms_ = now;
+    }
+    if ((now - this->last_write_ms_) >= this->min_write_interval_)
+    {
+        for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+        {
+            WriteSlot &write_slot = this->write_slots_[i];
+            if (!write_slot.dirty)
+                continue;
+            this->send_frame(s_write_slot_words[i][0], s_write_slot_words[i][1], write_slot.value);
+            this->send_frame(s_write_slot_words[i][2], s_write_slot_words[i][3], 0x0F);  // Read the setting back as acknowledgment
+            write_slot.dirty = false;
+            write_slot.status = WRITE_STATUS_SENT;
+            write_slot.sent_ms = now;
+            write_slot.retries++;
+            this->last_write_ms_ = now;
+            break;
+        }
+    }
+    this->publish_write_status();
+    if (this->restoring_ && this->write_status_ != WRITE_STATUS_PENDING)
+    {
+        this->restoring_ = false;
+        if (this->write_status_ == WRITE_STATUS_FAILED)
+        {
+            ESP_LOGW(TAG, "Radar configuration restore incomplete, some settings were not acknowledged");
+        }
+        else
+        {
+            ESP_LOGI(TAG, "Radar configuration restored");
+        }
+    }
+}
+
+// Write the whole configuration snapshot again in one burst, the radar has lost it or may have lost it
+void mr24hpc1Component::restore_configuration(const char *reason)
+{
+    this->cancel_timeout("restore_configuration");
+    bool any = false;
+    for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+    {
+        WriteSlot &write_slot = this->write_slots_[i];
+        if (!write_slot.has_target || !this->capabilities_.is_supported(s_write_slot_words[i][2], s_write_slot_words[i][3]))
+            continue;
+        write_slot.has_confirmed = false;   // Whatever the radar reported before is stale now
+        write_slot.dirty = true;
+        write_slot.retries = 0;
+        write_slot.status = WRITE_STATUS_PENDING;
+        any = true;
+    }
+    if (!any)
+        return;
+    ESP_LOGI(TAG, "Restoring the radar configuration (%s)", reason);
+    this->write_burst_ = true;
+    this->restoring_ = true;
+    this->enable_loop();
+    this->publish_write_status();
+}
+
+// Publish the last value the radar reported for a setting to its entity
+void mr24hpc1Component::publish_write_slot(uint8_t slot)
+{
+    WriteSlot &write_slot = this->write_slots_[slot];
+    if (!write_slot.has_confirmed)
+        return;
+    switch (slot)
+    {
+        case WRITE_SLOT_SCENE_MODE:
+            if (this->scene_mode_select_ != nullptr && write_slot.confirmed_value < 5 &&
+                !this->capabilities_.is_unsupported(CAPABILITY_SCENE_MODE))
+            {
+                this->scene_mode_select_->publish_state(s_scene_str[write_slot.confirmed_value]);
+            }
+            break;
+        case WRITE_SLOT_UNDERLYING_OPEN:
+            if (this->underly_open_function_switch_ != nullptr)
+            {
+                this->underly_open_function_switch_->publish_state(write_slot.confirmed_value);
+            }
+            break;
+    }
+}
+
+// Pending wins over failed, failed wins over confirmed
+void mr24hpc1Component::publish_write_status(void)
+{
+    uint8_t status = WRITE_STATUS_IDLE;
+    for (uint8_t i = 0; i < WRITE_SLOT_MAX; i++)
+    {
+        uint8_t slot_status = this->write_slots_[i].status;
+        if (slot_status == WRITE_STATUS_PENDING || slot_status == WRITE_STATUS_SENT)
+        {
+            status = WRITE_STATUS_PENDING;
+            break;
+        }
+        if (slot_status == WRITE_STATUS_FAILED || (slot_status == WRITE_STATUS_CONFIRMED && status == WRITE_STATUS_IDLE))
+        {
+            status = slot_status;
+        }
+    }
+    if (status == this->write_status_)
+        return;
+    this->write_status_ = status;
+    if (this->write_status_text_sensor_ != nullptr)
+    {
+        this->write_status_text_sensor_->publish_state(s_write_status_str[status]);
+    }
+}
+
+// Send Heartbeat Packet Command, the round trip is timed from the first unanswered heartbeat
+void mr24hpc1Component::get_heartbeat_packet(void)
+{
+    if (!this->heartbeat_pending_)
+    {
+        this->heartbeat_pending_ = true;
+        this->heartbeat_sent_ms_ = millis();
+    }
+    this->send_frame(0x01, 0x01, 0x0F);
+    this->enable_loop();   // check_link() times the reply
+}
+
+// Module reset, also used by the reset button
+void mr24hpc1Component::reset_module(void)
+{
+    this->send_frame(0x01, 0x02, 0x0F);
+    // The radar comes back with factory settings, restore them even if its init report gets lost
+    this->set_timeout("restore_configuration", MODULE_RESET_SETTLE_MS, [this]() { this->restore_configuration("module reset"); });
+}
+
+// Heartbeat timeout and RX stall detection, both escalate one recovery step at a time
+void mr24hpc1Component::check_link(void)
+{
+    uint32_t now = millis();
+    if (this->heartbeat_pending_ && (now - this->heartbeat_sent_ms_) > HEARTBEAT_REPLY_TIMEOUT_MS)
+    {
+        this->heartbeat_pending_ = false;
+        this->heartbeat_misses_++;
+        if (this->heartbeat_misses_sensor_ != nullptr)
+        {
+            this->heartbeat_misses_sensor_->publish_state(this->heartbeat_misses_);
+        }
+        ESP_LOGW(TAG, "Heartbeat not answered within %u ms (%u in a row)", HEARTBEAT_REPLY_TIMEOUT_MS, this->heartbeat_misses_);
+        this->publish_link_state(false);
+        this->escalate_link_recovery();
+    }
+    else if (!this->heartbeat_pending_ && this->recovery_step_ == LINK_RECOVERY_NONE &&
+             (now - this->last_report_ms_) > this->stall_intervals_ * this->get_update_interval())
+    {
+        // No report for several report intervals. The first stall checks right away whether the radar still
+        // answers, a missed heartbeat escalates from there. A radar that answers but stopped its periodic
+        // reports is reset on the next stall and re-initialized on the one after.
+        ESP_LOGW(TAG, "No report frame for %" PRIu32 " ms", now - this->last_report_ms_);
+        this->last_report_ms_ = now;   // One stall period until the next step
+        this->report_stalls_++;
+        if (this->report_stalls_ == 1 || !this->has_periodic_reports())
+        {
+            this->get_heartbeat_packet();
+        }
+        else if (this->report_stalls_ == 2)
+        {
+            ESP_LOGW(TAG, "Radar answers but stopped reporting, resetting the module");
+            this->reset_module();
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Radar still not reporting after reset, re-initializing");
+            this->reinitialize();
+        }
+    }
+}
+
+// Only a radar that has been reporting periodically since the last re-initialization can be
+// told apart from one that has nothing to report
+bool mr24hpc1Component::has_periodic_reports(void)
+{
+    for (const ReportInterval &entry : this->report_intervals_)
+    {
+        if (entry.is_periodic() && is_report_frame(entry.key >> 8, entry.key & 0xFF))
+            return true;
+    }
+    return false;
+}
+
+void mr24hpc1Component::escalate_link_recovery(void)
+{
+    switch (this->recovery_step_)
+    {
+        case LINK_RECOVERY_NONE:
+            this->recovery_step_ = LINK_RECOVERY_REQUERY;
+            this->get_heartbeat_packet();
+            break;
+        case LINK_RECOVERY_REQUERY:
+            ESP_LOGW(TAG, "Radar not answering, resetting the module");
+            this->recovery_step_ = LINK_RECOVERY_RESET;
+            this->reset_module();
+            this->set_timeout("link_recovery", MODULE_RESET_SETTLE_MS, [this]() { this->get_heartbeat_packet(); });
+            break;
+        default:
+            ESP_LOGW(TAG, "Radar still not answering after reset, re-initializing");
+            this->recovery_step_ = LINK_RECOVERY_REINIT;
+            this->reinitialize();
+            this->recovery_step_ = LINK_RECOVERY_NONE;   // Start over from the next report interval
+            break;
+    }
+}
+
+// Forget everything learned from the radar and run the power-up query sequence again
+void mr24hpc1Component::reinitialize(void)
+{
+    this->reset_frame();
+    this->coalescer_.clear();
+    this->output_info_switch_flag_ = OUTPUT_SWITCH_INIT;
+    this->power_on_status_ = 0;
+    memset(this->c_product_mode, 0, PRODUCT_BUF_MAX_SIZE);
+    memset(this->c_product_id, 0, PRODUCT_BUF_MAX_SIZE);
+    memset(this->c_firmware_version, 0, PRODUCT_BUF_MAX_SIZE);
+    memset(this->c_hardware_model, 0, PRODUCT_BUF_MAX_SIZE);
+    this->capabilities_keyed_ = false;   // Keyed again once the firmware version has been read back
+    this->capabilities_.reset();
+    this->capabilities_reprobe_ = true;
+    this->capability_reprobe_ms_ = CAPABILITY_REPROBE_MIN_MS;
+    this->cancel_timeout("capability_reprobe");
+    this->report_intervals_.reset();
+    this->last_report_ms_ = millis();
+    this->report_stalls_ = 0;
+    this->presence_reported_ = false;   // The restarted radar reports its presence again
+    this->restore_configuration("re-initialization");
+    // The next scheduled update() starts the power-up query sequence again
+}
+
+void mr24hpc1Component::publish_link_state(bool normal)
+{
+    if (this->link_normal_ == normal)
+        return;
+    this->link_normal_ = normal;
+    if (this->heartbeat_state_text_sensor_ != nullptr)
+    {
+        this->heartbeat_state_text_sensor_->publish_state(s_heartbeat_str[normal]);
+    }
 }
 
 // Issuance of the underlying open parameter query command
 void mr24hpc1Component::get_radar_output_information_switch(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x08, 0x80, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x08, 0x80, 0x0F);
 }
 
 // Issuance of product model orders
 void mr24hpc1Component::get_product_mode(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x02, 0xA1, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x02, 0xA1, 0x0F);
 }
 
 // Issuing the Get Product ID command
 void mr24hpc1Component::get_product_id(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x02, 0xA2, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x02, 0xA2, 0x0F);
 }
 
 // Issuing hardware model commands
 void mr24hpc1Component::get_hardware_model(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x02, 0xA3, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x02, 0xA3, 0x0F);
 }
 
 // Issuing software version commands
 void mr24hpc1Component::get_firmware_version(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x02, 0xA4, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x02, 0xA4, 0x0F);
 }
 
 void mr24hpc1Component::get_human_status(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x80, 0x81, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x80, 0x81, 0x0F);
 }
 
 void mr24hpc1Component::get_keep_away(void)
 {
-    unsigned char send_data_len = 10;
-    unsigned char send_data[10] = {0x53, 0x59, 0x80, 0x8B, 0x00, 0x01, 0x0F, 0x00, 0x54, 0x43};
-    send_data[FRAME_DATA_INDEX + 1] = get_frame_crc_sum(send_data, send_data_len);
-    this->send_query(send_data, send_data_len);
+    this->send_frame(0x80, 0x8B, 0x0F);
 }
 
 void mr24hpc1Component::set_underlying_open_function(bool enable)
 {
-    uint8_t underlyswitch_on[] = {0x53, 0x59, 0x08, 0x00, 0x00, 0x01, 0x01, 0xB6, 0x54, 0x43};
-    uint8_t underlyswitch_off[] = {0x53, 0x59, 0x08, 0x00, 0x00, 0x01, 0x00, 0xB5, 0x54, 0x43};
-    if(enable) send_query(underlyswitch_on, sizeof(underlyswitch_on));
-    else send_query(underlyswitch_off, sizeof(underlyswitch_off));
-    this->keep_away_text_sensor_->publish_state("");
+    this->queue_write(WRITE_SLOT_UNDERLYING_OPEN, enable ? 0x01 : 0x00);
+}
+
+// Reset the values that only make sense for the report stream that has just been switched off
+void mr24hpc1Component::clear_underlying_open_entities(void)
+{
+    if (!this->capabilities_.is_unsupported(CAPABILITY_KEEP_AWAY))
+    {
+        this->keep_away_text_sensor_->publish_state("");
+    }
     this->motion_status_text_sensor_->publish_state("");
     this->custom_spatial_static_value_sensor_->publish_state(0.0f);
     this->custom_spatial_motion_value_sensor_->publish_state(0.0f);
     this->custom_motion_distance_sensor_->publish_state(0.0f);
     this->custom_presence_of_detection_sensor_->publish_state(0.0f);
     this->custom_motion_speed_sensor_->publish_state(0.0f);
+    // Without the stream nothing reports a distance any more, so no zone can stay occupied
+    this->underlying_frame_ = {};
+    this->reset_target_tracker();
+    if (this->activity_text_sensor_ != nullptr && this->activity_classifier_.reset())
+    {
+        this->publish_activity();
+    }
+    this->zone_mask_ = 0;
+#ifdef USE_BINARY_SENSOR
+    for (binary_sensor::BinarySensor *zone_binary_sensor : this->zone_binary_sensors_)
+    {
+        zone_binary_sensor->publish_state(false);
+    }
+#endif
 }
 
 void mr24hpc1Component::set_scene_mode(const std::string &state){
     uint8_t cmd_value = SCENEMODE_ENUM_TO_INT.at(state);
     if(cmd_value == 0x00)return;
-    uint8_t scenemodeArr[10] = {0x53, 0x59, 0x05, 0x07, 0x00, 0x01, cmd_value, 0x00, 0x54, 0x43};
-    scenemodeArr[7] = get_frame_crc_sum(scenemodeArr, sizeof(scenemodeArr));
-    this->send_query(scenemodeArr, sizeof(scenemodeArr));
+    this->queue_write(WRITE_SLOT_SCENE_MODE, cmd_value);
 }
 
 }  // namespace empty_text_sensor
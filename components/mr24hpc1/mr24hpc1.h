@@ -22,41 +22,40 @@
 #ifdef USE_TEXT_SENSOR
 #include "esphome/components/text_sensor/text_sensor.h"
 #endif
+#ifdef USE_TIME
+#include "esphome/components/time/real_time_clock.h"
+#endif
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/seeed_radar/seeed_radar_protocol.h"
 #include "esphome/core/automation.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+#include "latency_histogram.h"
+#include "report_interval.h"
+#include "capability_table.h"
+#include "frame_coalescer.h"
+#include "presence_fusion.h"
+#include "target_tracker.h"
+#include "activity_classifier.h"
+#include "noise_floor.h"
+#include "frame_ring.h"
+#include "frame_stream.h"
+#include "frame_web.h"
+#include "event_log.h"
 
 #include <map>
+#include <vector>
 
 namespace esphome {
 namespace mr24hpc1 {
 
-#define FRAME_BUF_MAX_SIZE 128
+#define FRAME_DATA_MAX_SIZE 32
 #define PRODUCT_BUF_MAX_SIZE 32
 
-#define FRAME_HEADER1_VALUE 0x53
-#define FRAME_HEADER2_VALUE 0x59
-#define FRAME_TAIL1_VALUE 0x54
-#define FRAME_TAIL2_VALUE 0x43
-
 #define FRAME_CONTROL_WORD_INDEX 2
 #define FRAME_COMMAND_WORD_INDEX 3
 #define FRAME_DATA_INDEX 6
 
-enum
-{
-    FRAME_IDLE,
-    FRAME_HEADER2,
-    FRAME_CTL_WORLD,
-    FRAME_CMD_WORLD,
-    FRAME_DATA_LEN_H,
-    FRAME_DATA_LEN_L,
-    FRAME_DATA_BYTES,
-    FRAME_DATA_CRC,
-    FRAME_TAIL1,
-    FRAME_TAIL2,
-};
-
 enum
 {
     STANDARD_FUNCTION_QUERY_PRODUCT_MODE = 0,
@@ -93,6 +92,75 @@ enum
     OUTPUT_SWTICH_OFF,
 };
 
+// Settings that are written to the radar through the coalescing write buffer
+enum
+{
+    WRITE_SLOT_SCENE_MODE = 0,
+    WRITE_SLOT_UNDERLYING_OPEN,
+    WRITE_SLOT_EXISTENCE_THRESHOLD,
+    WRITE_SLOT_MOTION_THRESHOLD,
+    WRITE_SLOT_MAX,
+};
+
+enum
+{
+    WRITE_STATUS_IDLE,
+    WRITE_STATUS_PENDING,     // queued, waiting for the minimum write spacing
+    WRITE_STATUS_SENT,        // written, waiting for the radar to report the new value
+    WRITE_STATUS_CONFIRMED,
+    WRITE_STATUS_FAILED,
+};
+
+// Stages of the presence path, from the UART to the entity publish
+enum
+{
+    LATENCY_STAGE_RECEIVE = 0,    // frame header byte read until the frame tail is read
+    LATENCY_STAGE_PARSE,          // checksum and frame copy
+    LATENCY_STAGE_DISPATCH,       // control/command word dispatch until the entity publish starts
+    LATENCY_STAGE_PUBLISH,        // entity publish, including every listener attached to it
+    LATENCY_STAGE_TOTAL,          // frame header byte until the entity publish returns
+    LATENCY_STAGE_MAX,
+};
+
+// Escalation steps of the link monitor, one step per missed heartbeat
+enum
+{
+    LINK_RECOVERY_NONE = 0,
+    LINK_RECOVERY_REQUERY,      // send the heartbeat again right away
+    LINK_RECOVERY_RESET,        // module reset, the same command the reset button sends
+    LINK_RECOVERY_REINIT,       // restart the power-up query sequence
+};
+
+#define HEARTBEAT_REPLY_TIMEOUT_MS 1000
+#define MODULE_RESET_SETTLE_MS 3000
+
+#define WRITE_ACK_TIMEOUT_MS 1000
+#define WRITE_RETRY_MAX 3
+
+#define CALIBRATION_MIN_SAMPLES 10
+#define CALIBRATION_SIGMAS 3.0f
+#define ENERGY_MAX 250
+
+// Thresholds found by the last background calibration, kept in flash across reboots
+struct CalibrationResult
+{
+    uint8_t existence_threshold;
+    uint8_t motion_threshold;
+} __attribute__((packed));
+
+// One pending setting: the last requested value wins until it has been sent
+struct WriteSlot
+{
+    uint8_t value;
+    uint8_t confirmed_value;
+    uint8_t status;
+    uint8_t retries;
+    bool dirty;
+    bool has_confirmed;
+    bool has_target;       // value is part of the configuration snapshot restored after a radar re-init
+    uint32_t sent_ms;
+};
+
 static const std::map<std::string, uint8_t> SCENEMODE_ENUM_TO_INT{
   {"None", 0x00},
   {"Living Room", 0x01},
@@ -102,32 +170,31 @@ static const std::map<std::string, uint8_t> SCENEMODE_ENUM_TO_INT{
 };
 
 static const char* s_heartbeat_str[2] = {"Abnormal", "Normal"};
+static const char* s_write_status_str[5] = {"Idle", "Pending", "Pending", "Confirmed", "Failed"};
+// control word / command word of the set frame, followed by the control word / command word of the query that reports it back
+static const uint8_t s_write_slot_words[WRITE_SLOT_MAX][4] = {
+  {0x05, 0x07, 0x05, 0x87},   // scene mode
+  {0x08, 0x00, 0x08, 0x80},   // underlying open function switch
+  {0x08, 0x08, 0x08, 0x88},   // existence judgment threshold
+  {0x08, 0x09, 0x08, 0x89},   // motion amplitude trigger threshold
+};
 static const char* s_scene_str[5] = {"None", "Living Room", "Bedroom", "Washroom", "Area Detection"};
 static bool s_someoneExists_str[2] = {false, true};
 static const char* s_motion_status_str[3] = {"None", "Motionless", "Active"};
 static const char* s_keep_away_str[3] = {"None", "Close", "Away"};
+static const char* s_activity_str[ACTIVITY_MAX] = {"Empty", "Still", "Light Movement", "Walking", "Several People"};
 static int s_unmanned_time_str[9] = {0, 10, 30, 60, 120, 300, 600, 1800, 3600};   // unit: s
 static float s_motion_trig_boundary_str[10] = {0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5, 5.0};  // unit: m
 static float s_presence_of_perception_boundary_str[10] = {0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5, 5.0}; // uint: m
 static float s_presence_of_detection_range_str[7] = {0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0};  // uint: m
 
-static uint8_t s_output_info_switch_flag = OUTPUT_SWITCH_INIT;
-
-static uint8_t sg_recv_data_state = FRAME_IDLE;
-static uint8_t sg_frame_len = 0;
-static uint8_t sg_data_len = 0;
-static uint8_t sg_frame_buf[FRAME_BUF_MAX_SIZE] = {0};
-static uint8_t sg_frame_prase_buf[FRAME_BUF_MAX_SIZE] = {0};
-static bool sg_init_flag = false;
-static int sg_start_query_data = -1;
-static int sg_start_query_data_max = -1;
 static uint32_t sg_motion_trigger_time_bak;
 static uint32_t sg_move_to_rest_time_bak;
 static uint32_t sg_enter_unmanned_time_bak;
-static uint8_t sg_heartbeat_flag = 255;
-static uint8_t s_power_on_status = 0;
 
-class mr24hpc1Component : public PollingComponent, public uart::UARTDevice {      // The class name must be the name defined by text_sensor.py
+// The framing is done by the shared Seeed radar engine, this component is its decoder
+class mr24hpc1Component : public PollingComponent, public uart::UARTDevice,
+                          public seeed_radar::FrameEngine<mr24hpc1Component, FRAME_DATA_MAX_SIZE> {      // The class name must be the name defined by text_sensor.py
 #ifdef USE_TEXT_SENSOR
   SUB_TEXT_SENSOR(heartbeat_state)
   SUB_TEXT_SENSOR(product_model)
@@ -136,9 +203,13 @@ class mr24hpc1Component : public PollingComponent, public uart::UARTDevice {
   SUB_TEXT_SENSOR(firware_version)
   SUB_TEXT_SENSOR(keep_away)
   SUB_TEXT_SENSOR(motion_status)
+  SUB_TEXT_SENSOR(write_status)
+  SUB_TEXT_SENSOR(report_status)
+  SUB_TEXT_SENSOR(activity)
 #endif
 #ifdef USE_BINARY_SENSOR
   SUB_BINARY_SENSOR(someoneExists)
+  SUB_BINARY_SENSOR(fused_presence)
 #endif
 #ifdef USE_SENSOR
   SUB_SENSOR(custom_presence_of_detection)
@@ -147,6 +218,17 @@ class mr24hpc1Component : public PollingComponent, public uart::UARTDevice {
   SUB_SENSOR(custom_spatial_static_value)
   SUB_SENSOR(custom_spatial_motion_value)
   SUB_SENSOR(custom_motion_speed)
+  SUB_SENSOR(receive_latency)
+  SUB_SENSOR(parse_latency)
+  SUB_SENSOR(dispatch_latency)
+  SUB_SENSOR(publish_latency)
+  SUB_SENSOR(presence_latency)
+  SUB_SENSOR(heartbeat_rtt)
+  SUB_SENSOR(heartbeat_misses)
+  SUB_SENSOR(coalesced_frames)
+  SUB_SENSOR(tracked_distance)
+  SUB_SENSOR(tracked_velocity)
+  SUB_SENSOR(arrival_time)
 #endif
 #ifdef USE_SWITCH
   SUB_SWITCH(underly_open_function)
@@ -159,10 +241,153 @@ class mr24hpc1Component : public PollingComponent, public uart::UARTDevice {
 #endif
 
   private:
+    friend class seeed_radar::FrameEngine<mr24hpc1Component, FRAME_DATA_MAX_SIZE>;
+    void on_frame_start();
+    void on_frame_received();
+    void on_frame(uint8_t *frame, size_t len);
+    void on_frame_error(const char *reason, uint8_t value);
+    // Per instance state, several radars can be configured side by side
+    uint8_t output_info_switch_flag_{OUTPUT_SWITCH_INIT};
+    bool init_flag_{false};
+    int start_query_data_{-1};
+    int start_query_data_max_{-1};
+    // Link monitor
+    bool heartbeat_pending_{false};
+    uint8_t heartbeat_misses_{0};
+    uint8_t recovery_step_{LINK_RECOVERY_NONE};
+    int8_t link_normal_{-1};              // -1 until the first heartbeat was answered or missed
+    uint32_t heartbeat_sent_ms_{0};
+    uint32_t last_valid_frame_ms_{0};
+    uint32_t last_report_ms_{0};          // Reports the radar sends on its own, not replies to requests
+    uint8_t report_stalls_{0};            // Stall periods in a row without a report
+    uint8_t stall_intervals_{3};
+    void check_link(void);
+    uint32_t rx_poll_interval_{50};
+    bool has_pending_work(void);
+    bool fusion_hold_armed_{false};
+    void schedule_fusion_release(void);
+    bool has_periodic_reports(void);
+    void escalate_link_recovery(void);
+    void reinitialize(void);
+    void publish_link_state(bool normal);
+    uint8_t power_on_status_{0};
     char c_product_mode[PRODUCT_BUF_MAX_SIZE + 1];
     char c_product_id[PRODUCT_BUF_MAX_SIZE + 1];
     char c_hardware_model[PRODUCT_BUF_MAX_SIZE + 1];
     char c_firmware_version[PRODUCT_BUF_MAX_SIZE + 1];
+    WriteSlot write_slots_[WRITE_SLOT_MAX]{};
+    uint32_t min_write_interval_{500};
+    uint32_t last_write_ms_{0};
+    uint8_t write_status_{WRITE_STATUS_IDLE};
+    bool write_burst_{false};       // Send every dirty slot at once, ignoring the write spacing
+    bool restoring_{false};         // A configuration restore is waiting for its read-backs
+    LatencyHistogram latency_[LATENCY_STAGE_MAX];
+    uint32_t frame_start_us_{0};      // micros() when the frame header byte was read
+    uint32_t frame_receive_us_{0};    // duration of the receive stage of the current frame
+    uint32_t frame_parse_us_{0};      // duration of the parse stage of the current frame
+    uint32_t frame_complete_us_{0};   // micros() when the frame tail was read
+    uint32_t frame_dispatch_us_{0};   // micros() when the current frame was handed to the dispatcher
+    UnderlyingOpenFrame underlying_frame_{};
+    PresenceFusion presence_fusion_;
+    void process_underlying_open_frame(void);
+    void process_radar_presence(bool present);
+    void publish_fused_presence(void);
+    void process_zones(void);
+    TargetTracker target_tracker_;
+    bool tracker_enabled_{false};
+    int32_t tracked_distance_cm_{-1};    // Last published values at sensor resolution, -1 = none
+    int32_t tracked_velocity_cm_s_{0};
+    int32_t arrival_ds_{-1};
+    void process_target_tracker(void);
+    void reset_target_tracker(void);
+    void publish_target_tracker(void);
+    ActivityClassifier activity_classifier_;
+    void process_activity(void);
+    void publish_activity(void);
+#ifdef USE_MR24HPC1_FRAME_RING
+    FrameRing<FRAME_RING_SIZE> frame_ring_;   // Shared by every consumer of the raw underlying open frames
+#endif
+#ifdef USE_MR24HPC1_STREAM
+    FrameStreamer streamer_;
+    bool stream_flush_armed_{false};
+    void process_stream(void);
+#endif
+#ifdef USE_MR24HPC1_WEB
+    web_server_base::WebServerBase *web_base_{nullptr};
+    FrameWebHandler *web_handler_{nullptr};
+    std::string web_path_;
+#endif
+#ifdef USE_MR24HPC1_EVENT_LOG
+    EventLog event_log_;
+    uint32_t event_log_flush_interval_{600000};
+    uint8_t last_event_value_[4]{0xFF, 0xFF, 0xFF, 0xFF};   // Indexed by event type, 0xFF = nothing logged yet
+    CallbackManager<void(const EventRecord &)> event_log_record_callback_{};
+#ifdef USE_TIME
+    time::RealTimeClock *time_{nullptr};
+#endif
+#endif
+    void log_event(uint8_t type, uint8_t value);
+    CallbackManager<void(bool)> presence_callback_{};
+    CallbackManager<void(const UnderlyingOpenFrame &)> underlying_open_callback_{};
+    const uint32_t *zone_enter_lut_{nullptr};   // Bit n set: raw distance enters zone n
+    const uint32_t *zone_stay_lut_{nullptr};    // Bit n set: raw distance keeps zone n occupied
+    uint8_t zone_lut_size_{0};
+    uint32_t zone_mask_{0};
+#ifdef USE_BINARY_SENSOR
+    std::vector<binary_sensor::BinarySensor *> zone_binary_sensors_;
+#endif
+    ReportIntervalTable report_intervals_;
+    FrameCoalescer coalescer_;           // Newest stream report per command while the UART is drained
+    void flush_coalesced_frames(void);
+    void process_stream_sample(const uint8_t *data);
+    uint16_t report_problem_key_{0};     // Pair of the report problem published last, 0 = none
+    uint8_t report_problem_{REPORT_OK};
+    void check_report_intervals(void);
+    void record_publish_latency(uint32_t publish_start_us);
+    void publish_latency(void);
+    void process_write_slots(void);
+    void confirm_write(uint8_t slot, uint8_t value);
+    void publish_write_slot(uint8_t slot);
+    void publish_write_status(void);
+    void clear_underlying_open_entities(void);
+    void restore_configuration(const char *reason);
+    // Adaptive underlying open: the report stream only runs while the room is occupied
+    bool adaptive_stream_{false};
+    bool radar_present_{false};
+    bool presence_reported_{false};   // radar_present_ comes from a report, not from the default
+    bool motion_active_{false};
+    uint32_t unmanned_hold_time_{60000};
+    uint32_t min_toggle_interval_{10000};
+    uint32_t last_occupied_ms_{0};
+    uint32_t last_stream_toggle_ms_{0};
+    bool stream_toggled_{false};
+    void process_motion_status(uint8_t status);
+    void update_adaptive_stream(void);
+    // Background calibration of the existence and motion thresholds on an empty room
+    uint32_t preference_hash_{0};
+    ESPPreferenceObject calibration_pref_;
+    NoiseFloorEstimator static_noise_;
+    NoiseFloorEstimator motion_noise_;
+    bool calibrating_{false};
+    bool calibration_stream_on_{false};   // The calibration switched the underlying open stream on
+    uint8_t calibration_margin_{0};
+    void process_calibration_sample(void);
+    void finish_calibration(void);
+    void stop_calibration(void);
+    void apply_calibration(const CalibrationResult &result);
+    // Commands the connected firmware answers, probed once per firmware version and hardware model
+    CapabilityTable capabilities_;
+    ESPPreferenceObject capability_pref_;
+    bool capabilities_keyed_{false};     // Firmware version and hardware model are known, probing counts
+    bool capabilities_reprobe_{false};  // The radar restarted, probe the unsupported commands again once keyed
+    uint32_t capability_reprobe_ms_{CAPABILITY_REPROBE_MIN_MS};
+    void schedule_capability_reprobe(void);
+    void reprobe_capabilities(void);
+    void publish_unsupported_capabilities(void);
+    void load_capabilities(void);
+    void capability_sent(uint8_t control, uint8_t command);
+    void capability_answered(uint8_t control, uint8_t command);
+    void save_capabilities(void);
   public:
     mr24hpc1Component() : PollingComponent(8000) {}
     float get_setup_priority() const override { return esphome::setup_priority::LATE; }
@@ -170,13 +395,86 @@ class mr24hpc1Component : public PollingComponent, public uart::UARTDevice {
     void update() override;
     void dump_config() override;
     void loop() override;
-    void R24_split_data_frame(uint8_t value);
+    void on_shutdown() override;
     void R24_parse_data_frame(uint8_t *data, uint8_t len);
     void R24_frame_parse_open_underlying_information(uint8_t *data);
     void R24_frame_parse_work_status(uint8_t *data);
     void R24_frame_parse_product_Information(uint8_t *data);
     void R24_frame_parse_human_information(uint8_t *data);
     void send_query(uint8_t *query, size_t string_length);
+    void send_frame(uint8_t control, uint8_t command, uint8_t value);
+    void queue_write(uint8_t slot, uint8_t value);
+    void set_min_write_interval(uint32_t interval) { this->min_write_interval_ = interval; }
+    void set_stall_intervals(uint8_t intervals) { this->stall_intervals_ = intervals; }
+    void set_rx_poll_interval(uint32_t interval) { this->rx_poll_interval_ = interval; }
+    void set_preference_hash(uint32_t hash) { this->preference_hash_ = hash; }
+    void start_calibration(uint32_t duration, uint8_t margin);
+    void set_adaptive_underlying_open(uint32_t unmanned_hold_time, uint32_t min_toggle_interval)
+    {
+        this->adaptive_stream_ = true;
+        this->unmanned_hold_time_ = unmanned_hold_time;
+        this->min_toggle_interval_ = min_toggle_interval;
+    }
+    void reset_module(void);
+    // Listeners for decoded radar data, called from loop() right after the frame was parsed
+    uint32_t get_last_frame_ms() const { return this->last_valid_frame_ms_; }   // Any valid frame, heartbeat replies included
+    void add_on_presence_callback(std::function<void(bool)> &&callback) { this->presence_callback_.add(std::move(callback)); }
+    void add_on_underlying_open_callback(std::function<void(const UnderlyingOpenFrame &)> &&callback)
+    {
+        this->underlying_open_callback_.add(std::move(callback));
+    }
+#ifdef USE_MR24HPC1_EVENT_LOG
+    void set_event_log(uint8_t pages, uint32_t flush_interval)
+    {
+        this->event_log_.set_pages(pages);
+        this->event_log_flush_interval_ = flush_interval;
+    }
+    // Called for every record dump_event_log() replays
+    void add_on_event_log_record_callback(std::function<void(const EventRecord &)> &&callback)
+    {
+        this->event_log_record_callback_.add(std::move(callback));
+    }
+#ifdef USE_TIME
+    void set_time(time::RealTimeClock *time) { this->time_ = time; }
+#endif
+#endif
+    void dump_event_log(void);
+#ifdef USE_MR24HPC1_WEB
+    void set_web_server(web_server_base::WebServerBase *base, const std::string &path)
+    {
+        this->web_base_ = base;
+        this->web_path_ = path;
+    }
+#endif
+#ifdef USE_MR24HPC1_STREAM
+    void set_stream_target(const std::string &host, uint16_t port, bool tcp) { this->streamer_.set_target(host, port, tcp); }
+    void set_stream_batch(uint8_t batch_size, uint32_t flush_interval) { this->streamer_.set_batch(batch_size, flush_interval); }
+#endif
+    void configure_target_tracker(uint16_t alpha, uint16_t beta)
+    {
+        this->tracker_enabled_ = true;
+        this->target_tracker_.set_alpha(alpha);
+        this->target_tracker_.set_beta(beta);
+    }
+    void set_activity_window(uint8_t window_size, uint8_t confirm_count)
+    {
+        this->activity_classifier_.set_window_size(window_size);
+        this->activity_classifier_.set_confirm_count(confirm_count);
+    }
+    // Bias and weights in Q8, weights in feature order: static energy, motion energy, movement signs,
+    // speed, motion energy stddev, distance jump
+    void set_activity_class(uint8_t activity, int32_t bias, int16_t static_energy, int16_t motion_energy, int16_t movement_signs,
+                            int16_t speed, int16_t motion_stddev, int16_t distance_jump)
+    {
+        const int16_t weights[ACTIVITY_FEATURE_MAX] = {static_energy, motion_energy, movement_signs, speed, motion_stddev, distance_jump};
+        this->activity_classifier_.set_class(activity, bias, weights);
+    }
+    void set_zone_lookup(const uint32_t *enter_lut, const uint32_t *stay_lut, uint8_t size);
+#ifdef USE_BINARY_SENSOR
+    void add_zone_binary_sensor(binary_sensor::BinarySensor *sens) { this->zone_binary_sensors_.push_back(sens); }
+#endif
+    void configure_presence_fusion(uint8_t motion_threshold, uint8_t static_threshold, uint8_t movement_threshold,
+                                   uint8_t hysteresis, uint8_t max_distance, uint32_t hold_time);
     void get_heartbeat_packet(void);
     void get_radar_output_information_switch(void);
     void get_product_mode(void);
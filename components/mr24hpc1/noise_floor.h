@@ -0,0 +1,57 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+// Streaming mean, variance and peak of an energy value (Welford), constant memory, O(1) per sample
+class NoiseFloorEstimator
+{
+  public:
+    void reset()
+    {
+        this->count_ = 0;
+        this->mean_ = 0.0f;
+        this->m2_ = 0.0f;
+        this->max_ = 0;
+    }
+
+    void add(uint8_t value)
+    {
+        this->count_++;
+        float delta = value - this->mean_;
+        this->mean_ += delta / this->count_;
+        this->m2_ += delta * (value - this->mean_);
+        if (value > this->max_)
+        {
+            this->max_ = value;
+        }
+    }
+
+    uint32_t count() const { return this->count_; }
+    float mean() const { return this->mean_; }
+    float stddev() const { return this->count_ > 1 ? sqrtf(this->m2_ / (this->count_ - 1)) : 0.0f; }
+    uint8_t max() const { return this->max_; }
+
+    // Lowest value that stays clear of the noise: above the observed peak and above mean + sigmas * stddev
+    uint8_t threshold(float sigmas, uint8_t margin, uint8_t limit) const
+    {
+        float floor = this->mean_ + sigmas * this->stddev();
+        if (floor < this->max_)
+        {
+            floor = this->max_;
+        }
+        float threshold = ceilf(floor) + margin;
+        return threshold > limit ? limit : (uint8_t) threshold;
+    }
+
+  protected:
+    uint32_t count_{0};
+    float mean_{0.0f};
+    float m2_{0.0f};
+    uint8_t max_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
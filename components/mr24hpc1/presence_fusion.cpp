@@ -0,0 +1,76 @@
+#include "presence_fusion.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+// Once the room is occupied the thresholds drop by the hysteresis, so weaker evidence keeps it occupied
+bool PresenceFusion::exceeds(uint8_t value, uint8_t threshold) const
+{
+    if (threshold == 0)
+        return false;   // A zero threshold disables that input
+    uint8_t offset = this->present_ ? this->hysteresis_ : 0;
+    uint8_t effective = threshold > offset ? threshold - offset : 1;
+    return value >= effective;
+}
+
+// The radar report stands in for the stream while no frames arrive
+bool PresenceFusion::radar_holds(uint32_t now) const
+{
+    return this->present_ && this->radar_present_ && (!this->has_frame_ || (now - this->last_frame_ms_) >= this->hold_time_);
+}
+
+bool PresenceFusion::mark_evidence(uint32_t now)
+{
+    this->last_evidence_ms_ = now;
+    if (this->present_)
+        return false;
+    this->present_ = true;
+    return true;
+}
+
+bool PresenceFusion::feed(const UnderlyingOpenFrame &frame, uint32_t now)
+{
+    this->last_frame_ms_ = now;
+    this->has_frame_ = true;
+    bool motion_in_range = this->max_distance_ == 0 || frame.motion_distance <= this->max_distance_;
+    bool static_in_range = this->max_distance_ == 0 || frame.presence_distance <= this->max_distance_;
+    if ((motion_in_range && this->exceeds(frame.motion_energy, this->motion_threshold_)) ||
+        (motion_in_range && this->exceeds(frame.movement_signs, this->movement_threshold_)) ||
+        (static_in_range && this->exceeds(frame.static_energy, this->static_threshold_)))
+    {
+        return this->mark_evidence(now);
+    }
+    return this->expire(now);
+}
+
+// The radar reports someone arriving quickly, only its release is left to the local hold time
+bool PresenceFusion::feed_radar_presence(bool present, uint32_t now)
+{
+    if (present)
+    {
+        this->radar_present_ = true;
+        return this->mark_evidence(now);
+    }
+    if (this->radar_holds(now))
+    {
+        this->last_evidence_ms_ = now;   // The report held the room until now, the hold time starts here
+    }
+    this->radar_present_ = false;
+    return this->expire(now);
+}
+
+bool PresenceFusion::expire(uint32_t now)
+{
+    if (!this->present_ || (now - this->last_evidence_ms_) < this->hold_time_)
+        return false;
+    if (this->radar_holds(now))
+    {
+        this->last_evidence_ms_ = now;   // No stream to decide with, the radar report still stands
+        return false;
+    }
+    this->present_ = false;
+    return true;
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+// Latest values of the underlying open report stream, raw as sent by the radar
+struct UnderlyingOpenFrame
+{
+    uint8_t static_energy;       // 0-250
+    uint8_t presence_distance;   // 0.5 m steps
+    uint8_t motion_energy;       // 0-250
+    uint8_t motion_distance;     // 0.5 m steps
+    uint8_t motion_speed;        // (value - 10) * 0.5 m/s
+    uint8_t movement_signs;      // 0-100
+};
+
+// Local presence decision from the underlying open stream. A frame with enough motion energy,
+// static energy or body movement within range marks the room occupied, it is released once no
+// frame has carried such evidence for the hold time. Integer compares only, O(1) per frame.
+// The radar reports presence only when it changes, so while it reports someone present and no
+// stream frames arrive (the stream is off) that report keeps the room occupied.
+class PresenceFusion
+{
+  public:
+    void set_motion_threshold(uint8_t threshold) { this->motion_threshold_ = threshold; }
+    void set_static_threshold(uint8_t threshold) { this->static_threshold_ = threshold; }
+    void set_movement_threshold(uint8_t threshold) { this->movement_threshold_ = threshold; }
+    void set_hysteresis(uint8_t hysteresis) { this->hysteresis_ = hysteresis; }
+    void set_max_distance(uint8_t max_distance) { this->max_distance_ = max_distance; }
+    void set_hold_time(uint32_t hold_time) { this->hold_time_ = hold_time; }
+
+    // Both return true when the fused state changed
+    bool feed(const UnderlyingOpenFrame &frame, uint32_t now);
+    bool feed_radar_presence(bool present, uint32_t now);
+    bool expire(uint32_t now);
+
+    bool is_present() const { return this->present_; }
+    // Time left until expire() releases the room without new evidence, 0 when it is not occupied
+    uint32_t hold_remaining(uint32_t now) const
+    {
+        if (!this->present_)
+            return 0;
+        uint32_t elapsed = now - this->last_evidence_ms_;
+        return elapsed < this->hold_time_ ? this->hold_time_ - elapsed : 1;
+    }
+
+  protected:
+    bool exceeds(uint8_t value, uint8_t threshold) const;
+    bool mark_evidence(uint32_t now);
+    bool radar_holds(uint32_t now) const;
+
+    uint8_t motion_threshold_{20};
+    uint8_t static_threshold_{40};
+    uint8_t movement_threshold_{5};
+    uint8_t hysteresis_{5};
+    uint8_t max_distance_{0};      // 0.5 m steps, 0 disables the distance gate
+    uint32_t hold_time_{5000};
+    bool present_{false};
+    bool radar_present_{false};
+    uint32_t last_evidence_ms_{0};
+    uint32_t last_frame_ms_{0};
+    bool has_frame_{false};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
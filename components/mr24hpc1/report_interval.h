@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define REPORT_INTERVAL_SLOTS 32        // Distinct (control, command) pairs tracked, power of two
+#define REPORT_INTERVAL_MIN_SAMPLES 8   // Intervals seen before a report counts as periodic
+#define REPORT_STALL_FACTOR 3           // No report for this many mean intervals: stalled
+#define REPORT_SLOW_FACTOR 2            // Recent mean interval this many times the long term one: slowed down
+
+enum
+{
+    REPORT_OK = 0,
+    REPORT_SLOW,
+    REPORT_STALLED,
+};
+
+// Inter-arrival statistics of one (control, command) pair. Means are EWMAs in 1/16 ms:
+// the recent one follows with 1/8 weight, the baseline with 1/128. Jitter is the RFC 3550
+// estimator, the EWMA (1/16) of the deviation of each interval from the recent mean.
+struct ReportInterval
+{
+    uint16_t key;          // control << 8 | command, 0 = free slot
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint32_t mean_q4;
+    uint32_t baseline_q4;
+    uint32_t jitter_q4;
+
+    uint32_t mean_ms() const { return this->mean_q4 >> 4; }
+    uint32_t jitter_ms() const { return this->jitter_q4 >> 4; }
+    // Only regular reports are checked, event driven ones like presence changes have a jitter close to their mean
+    bool is_periodic() const { return this->count > REPORT_INTERVAL_MIN_SAMPLES && this->jitter_q4 * 2 < this->mean_q4; }
+
+    uint8_t check(uint32_t now) const
+    {
+        if (!this->is_periodic())
+            return REPORT_OK;
+        if ((now - this->last_ms) > REPORT_STALL_FACTOR * this->mean_ms())
+            return REPORT_STALLED;
+        if (this->mean_q4 > REPORT_SLOW_FACTOR * this->baseline_q4)
+            return REPORT_SLOW;
+        return REPORT_OK;
+    }
+};
+
+// Fixed open addressed table of report intervals, recording is O(1) per frame
+class ReportIntervalTable
+{
+  public:
+    void record(uint8_t control, uint8_t command, uint32_t now)
+    {
+        ReportInterval *entry = this->find(control, command);
+        if (entry == nullptr)
+            return;   // Table full, more pairs than the radar protocol uses
+        if (entry->count++ == 0)
+        {
+            entry->last_ms = now;
+            return;
+        }
+        uint32_t interval = now - entry->last_ms;
+        entry->last_ms = now;
+        uint32_t interval_q4 = interval << 4;
+        if (entry->count == 2)
+        {
+            entry->min_ms = entry->max_ms = interval;
+            entry->mean_q4 = entry->baseline_q4 = interval_q4;
+            return;
+        }
+        if (interval < entry->min_ms)
+            entry->min_ms = interval;
+        if (interval > entry->max_ms)
+            entry->max_ms = interval;
+        uint32_t deviation = interval_q4 > entry->mean_q4 ? interval_q4 - entry->mean_q4 : entry->mean_q4 - interval_q4;
+        entry->jitter_q4 = entry->jitter_q4 + deviation / 16 - entry->jitter_q4 / 16;
+        entry->mean_q4 = entry->mean_q4 + interval_q4 / 8 - entry->mean_q4 / 8;
+        entry->baseline_q4 = entry->baseline_q4 + interval_q4 / 128 - entry->baseline_q4 / 128;
+    }
+
+    void reset()
+    {
+        for (auto &entry : this->entries_)
+        {
+            entry = ReportInterval{};
+        }
+    }
+
+    const ReportInterval *begin() const { return this->entries_; }
+    const ReportInterval *end() const { return this->entries_ + REPORT_INTERVAL_SLOTS; }
+
+  protected:
+    ReportInterval *find(uint8_t control, uint8_t command)
+    {
+        uint16_t key = (control << 8) | command;
+        if (key == 0)
+            return nullptr;
+        uint8_t index = (control * 7 + command) & (REPORT_INTERVAL_SLOTS - 1);
+        for (uint8_t probe = 0; probe < REPORT_INTERVAL_SLOTS; probe++)
+        {
+            ReportInterval &entry = this->entries_[(index + probe) & (REPORT_INTERVAL_SLOTS - 1)];
+            if (entry.key == key)
+                return &entry;
+            if (entry.key == 0)
+            {
+                entry.key = key;
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    ReportInterval entries_[REPORT_INTERVAL_SLOTS]{};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
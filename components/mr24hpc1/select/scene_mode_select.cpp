@@ -4,7 +4,7 @@ namespace esphome {
 namespace mr24hpc1 {
 
 void SceneModeSelect::control(const std::string &value) {
-  this->publish_state(value);
+  // The new state is published once the radar reports it back
   this->parent_->set_scene_mode(value);
 }
 
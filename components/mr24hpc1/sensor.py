@@ -5,7 +5,14 @@ from esphome.const import (
     DEVICE_CLASS_DISTANCE,
     DEVICE_CLASS_ENERGY,
     DEVICE_CLASS_SPEED,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_METER,
+    UNIT_METER_PER_SECOND,
+    UNIT_MICROSECOND,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
 )
 from . import CONF_MR24HPC1_ID, mr24hpc1Component
 
@@ -17,6 +24,33 @@ CONF_CUSTOMMOTIONDISTANCE = "custommotiondistance"
 CONF_CUSTOMSPATIALSTATICVALUE = "customspatialstaticvalue"
 CONF_CUSTOMSPATIALMOTIONVALUE = "customspatialmotionvalue"
 CONF_CUSTOMMOTIONSPEED =  "custommotionspeed"
+# 95th percentile latency of each stage between the UART and the presence entity publish, over one
+# update interval. Timing starts at the frame header byte, the wait of up to rx_poll_interval before
+# a sleeping loop() wakes up and reads it is not included.
+CONF_RECEIVELATENCY = "receivelatency"
+CONF_PARSELATENCY = "parselatency"
+CONF_DISPATCHLATENCY = "dispatchlatency"
+CONF_PUBLISHLATENCY = "publishlatency"
+CONF_PRESENCELATENCY = "presencelatency"
+CONF_HEARTBEATRTT = "heartbeatrtt"
+CONF_HEARTBEATMISSES = "heartbeatmisses"
+# Stream reports dropped because a newer one of the same kind arrived during the same UART drain
+CONF_COALESCEDFRAMES = "coalescedframes"
+# Motion target tracker, smoothed from the 0.5 m / 0.5 m/s steps of the underlying open stream
+CONF_TRACKEDDISTANCE = "trackeddistance"
+CONF_TRACKEDVELOCITY = "trackedvelocity"
+CONF_ARRIVALTIME = "arrivaltime"
+CONF_TRACKER_ALPHA = "tracker_alpha"
+CONF_TRACKER_BETA = "tracker_beta"
+TRACKER_SENSORS = (CONF_TRACKEDDISTANCE, CONF_TRACKEDVELOCITY, CONF_ARRIVALTIME)
+
+LATENCY_SENSOR_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    icon="mdi:timer-outline",
+)
 
 
 CONFIG_SCHEMA = cv.Schema(
@@ -49,6 +83,55 @@ CONFIG_SCHEMA = cv.Schema(
             accuracy_decimals=2,
             icon="mdi:run-fast"
         ),
+        cv.Optional(CONF_RECEIVELATENCY): LATENCY_SENSOR_SCHEMA,
+        cv.Optional(CONF_PARSELATENCY): LATENCY_SENSOR_SCHEMA,
+        cv.Optional(CONF_DISPATCHLATENCY): LATENCY_SENSOR_SCHEMA,
+        cv.Optional(CONF_PUBLISHLATENCY): LATENCY_SENSOR_SCHEMA,
+        cv.Optional(CONF_PRESENCELATENCY): LATENCY_SENSOR_SCHEMA,
+        cv.Optional(CONF_HEARTBEATRTT): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:timer-sync-outline",
+        ),
+        cv.Optional(CONF_HEARTBEATMISSES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:heart-broken",
+        ),
+        cv.Optional(CONF_COALESCEDFRAMES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:layers-minus",
+        ),
+        cv.Optional(CONF_TRACKEDDISTANCE): sensor.sensor_schema(
+            device_class=DEVICE_CLASS_DISTANCE,
+            unit_of_measurement=UNIT_METER,
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon="mdi:signal-distance-variant",
+        ),
+        # Negative while the target approaches the radar
+        cv.Optional(CONF_TRACKEDVELOCITY): sensor.sensor_schema(
+            device_class=DEVICE_CLASS_SPEED,
+            unit_of_measurement=UNIT_METER_PER_SECOND,
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon="mdi:run-fast",
+        ),
+        # Seconds until an approaching target reaches the radar, unknown otherwise
+        cv.Optional(CONF_ARRIVALTIME): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon="mdi:timer-sand",
+        ),
+        # Position and velocity gains of the alpha-beta filter, higher follows faster but smooths less
+        cv.Optional(CONF_TRACKER_ALPHA, default=0.5): cv.float_range(min=0.01, max=1.0),
+        cv.Optional(CONF_TRACKER_BETA, default=0.1): cv.float_range(min=0.0, max=1.0),
     }
 )
 
@@ -73,3 +156,43 @@ async def to_code(config):
     if custommotionspeed_config := config.get(CONF_CUSTOMMOTIONSPEED):
         sens = await sensor.new_sensor(custommotionspeed_config)
         cg.add(mr24hpc1_component.set_custom_motion_speed_sensor(sens))
+    if receivelatency_config := config.get(CONF_RECEIVELATENCY):
+        sens = await sensor.new_sensor(receivelatency_config)
+        cg.add(mr24hpc1_component.set_receive_latency_sensor(sens))
+    if parselatency_config := config.get(CONF_PARSELATENCY):
+        sens = await sensor.new_sensor(parselatency_config)
+        cg.add(mr24hpc1_component.set_parse_latency_sensor(sens))
+    if dispatchlatency_config := config.get(CONF_DISPATCHLATENCY):
+        sens = await sensor.new_sensor(dispatchlatency_config)
+        cg.add(mr24hpc1_component.set_dispatch_latency_sensor(sens))
+    if publishlatency_config := config.get(CONF_PUBLISHLATENCY):
+        sens = await sensor.new_sensor(publishlatency_config)
+        cg.add(mr24hpc1_component.set_publish_latency_sensor(sens))
+    if presencelatency_config := config.get(CONF_PRESENCELATENCY):
+        sens = await sensor.new_sensor(presencelatency_config)
+        cg.add(mr24hpc1_component.set_presence_latency_sensor(sens))
+    if heartbeatrtt_config := config.get(CONF_HEARTBEATRTT):
+        sens = await sensor.new_sensor(heartbeatrtt_config)
+        cg.add(mr24hpc1_component.set_heartbeat_rtt_sensor(sens))
+    if heartbeatmisses_config := config.get(CONF_HEARTBEATMISSES):
+        sens = await sensor.new_sensor(heartbeatmisses_config)
+        cg.add(mr24hpc1_component.set_heartbeat_misses_sensor(sens))
+    if coalescedframes_config := config.get(CONF_COALESCEDFRAMES):
+        sens = await sensor.new_sensor(coalescedframes_config)
+        cg.add(mr24hpc1_component.set_coalesced_frames_sensor(sens))
+    if trackeddistance_config := config.get(CONF_TRACKEDDISTANCE):
+        sens = await sensor.new_sensor(trackeddistance_config)
+        cg.add(mr24hpc1_component.set_tracked_distance_sensor(sens))
+    if trackedvelocity_config := config.get(CONF_TRACKEDVELOCITY):
+        sens = await sensor.new_sensor(trackedvelocity_config)
+        cg.add(mr24hpc1_component.set_tracked_velocity_sensor(sens))
+    if arrivaltime_config := config.get(CONF_ARRIVALTIME):
+        sens = await sensor.new_sensor(arrivaltime_config)
+        cg.add(mr24hpc1_component.set_arrival_time_sensor(sens))
+    if any(key in config for key in TRACKER_SENSORS):
+        cg.add(
+            mr24hpc1_component.configure_target_tracker(
+                round(config[CONF_TRACKER_ALPHA] * 256),   # Q8 fixed point gains
+                round(config[CONF_TRACKER_BETA] * 256),
+            )
+        )
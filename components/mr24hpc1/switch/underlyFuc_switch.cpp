@@ -4,7 +4,7 @@ namespace esphome {
 namespace mr24hpc1 {
 
 void UnderlyOpenFunctionSwitch::write_state(bool state) {
-  this->publish_state(state);
+  // The new state is published once the radar reports it back
   this->parent_->set_underlying_open_function(state);
 }
 
@@ -0,0 +1,69 @@
+#include "target_tracker.h"
+
+namespace esphome {
+namespace mr24hpc1 {
+
+bool TargetTracker::feed(uint8_t raw_distance, uint8_t raw_speed, uint32_t now)
+{
+    if (raw_distance == 0)
+    {
+        this->tracking_ = false;
+        return false;
+    }
+    int32_t measured_mm = (int32_t) raw_distance * 500;
+    uint32_t dt = now - this->last_ms_;
+    if (!this->tracking_ || dt >= TRACKER_LOST_MS)
+    {
+        // New target, start at the measured position at rest
+        this->tracking_ = true;
+        this->distance_mm_ = measured_mm;
+        this->velocity_mm_s_ = 0;
+        this->last_ms_ = now;
+        return true;
+    }
+
+    // Predict, then correct with the distance residual
+    int32_t predicted_mm = this->distance_mm_;
+    if (dt >= TRACKER_MIN_DT_MS)
+    {
+        predicted_mm += (int32_t) ((int64_t) this->velocity_mm_s_ * dt / 1000);
+    }
+    int32_t residual = measured_mm - predicted_mm;
+    this->distance_mm_ = predicted_mm + (int32_t) ((int64_t) this->alpha_ * residual / TRACKER_GAIN_ONE);
+    if (dt >= TRACKER_MIN_DT_MS)
+    {
+        this->velocity_mm_s_ += (int32_t) ((int64_t) this->beta_ * residual * 1000 / ((int64_t) dt * TRACKER_GAIN_ONE));
+        this->last_ms_ = now;
+    }
+
+    // The radar speed only pulls the magnitude of the velocity, its direction comes from the distance track.
+    // It is quantized to 0.5 m/s, so it only corrects a velocity outside of half a step around the reading.
+    // A zero speed byte is skipped, slow walkers report it while still moving.
+    int32_t measured_speed = (raw_speed >= 10 ? raw_speed - 10 : 10 - raw_speed) * TRACKER_SPEED_STEP_MM_S;
+    if (measured_speed != 0 && this->velocity_mm_s_ != 0)
+    {
+        int32_t speed = this->velocity_mm_s_ < 0 ? -this->velocity_mm_s_ : this->velocity_mm_s_;
+        int32_t error = 0;
+        if (speed < measured_speed - TRACKER_SPEED_STEP_MM_S / 2)
+            error = measured_speed - TRACKER_SPEED_STEP_MM_S / 2 - speed;
+        else if (speed > measured_speed + TRACKER_SPEED_STEP_MM_S / 2)
+            error = measured_speed + TRACKER_SPEED_STEP_MM_S / 2 - speed;
+        int32_t correction = (int32_t) ((int64_t) this->beta_ * error / TRACKER_GAIN_ONE);
+        this->velocity_mm_s_ += this->velocity_mm_s_ < 0 ? -correction : correction;
+    }
+    if (this->distance_mm_ < 0)
+    {
+        this->distance_mm_ = 0;
+    }
+    return true;
+}
+
+int32_t TargetTracker::arrival_ms() const
+{
+    if (!this->tracking_ || this->velocity_mm_s_ > -TRACKER_APPROACH_MM_S)
+        return -1;
+    return (int32_t) ((int64_t) this->distance_mm_ * 1000 / -this->velocity_mm_s_);
+}
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace mr24hpc1 {
+
+#define TRACKER_GAIN_ONE 256          // Filter gains are Q8 fixed point, 256 = 1.0
+#define TRACKER_MIN_DT_MS 50          // Reports closer than this only correct the position
+#define TRACKER_LOST_MS 3000          // A target not reported for this long is dropped
+#define TRACKER_APPROACH_MM_S 100     // Slower targets are not considered approaching
+#define TRACKER_SPEED_STEP_MM_S 500   // Quantization of the radar speed byte
+
+// Alpha-beta tracker on the quantized motion distance of the underlying open stream.
+// Position in mm and velocity in mm/s, integer math and constant state, O(1) per report.
+// Negative velocity means the target gets closer to the radar.
+class TargetTracker
+{
+  public:
+    void set_alpha(uint16_t alpha) { this->alpha_ = alpha; }
+    void set_beta(uint16_t beta) { this->beta_ = beta; }
+
+    // raw_distance in 0.5 m steps, 0 = no moving target. raw_speed is the radar speed byte,
+    // (value - 10) * 0.5 m/s. Returns false while no target is tracked.
+    bool feed(uint8_t raw_distance, uint8_t raw_speed, uint32_t now);
+    void reset() { this->tracking_ = false; }
+
+    bool is_tracking() const { return this->tracking_; }
+    int32_t distance_mm() const { return this->distance_mm_; }
+    int32_t velocity_mm_s() const { return this->velocity_mm_s_; }
+    // Time until the target reaches the radar at its current velocity, -1 when it is not approaching
+    int32_t arrival_ms() const;
+
+  protected:
+    uint16_t alpha_{128};
+    uint16_t beta_{26};
+    bool tracking_{false};
+    int32_t distance_mm_{0};
+    int32_t velocity_mm_s_{0};
+    uint32_t last_ms_{0};
+};
+
+}  // namespace mr24hpc1
+}  // namespace esphome
@@ -12,6 +12,42 @@ CONF_FIRWAREVERSION = "hardwareversion"
 
 CONF_KEEPAWAY = "keepaway"
 CONF_MOTIONSTATUS = "motionstatus"
+CONF_WRITESTATUS = "writestatus"
+# OK, or the first periodic radar report that stalled or slowed down, e.g. "0x08/0x01 stalled"
+CONF_REPORTSTATUS = "reportstatus"
+CONF_ACTIVITY = "activity"
+CONF_WINDOW_SIZE = "window_size"
+CONF_CONFIRM_COUNT = "confirm_count"
+CONF_MODEL = "model"
+CONF_BIAS = "bias"
+
+# Classes of the activity classifier, in the order of the ACTIVITY_* enum
+ACTIVITY_CLASSES = ["empty", "still", "light_movement", "walking", "several_people"]
+# Window features of the underlying open stream, in the order of the ACTIVITY_FEATURE_* enum
+ACTIVITY_FEATURES = [
+    "static_energy",
+    "motion_energy",
+    "movement_signs",
+    "speed",
+    "motion_stddev",
+    "distance_jump",
+]
+# Hand tuned starting point, fit the coefficients to recordings of the actual room for better results
+ACTIVITY_DEFAULT_MODEL = {
+    "empty": {"bias": 60, "static_energy": -1.0, "motion_energy": -1.0, "movement_signs": -2.0},
+    "still": {"bias": 30, "static_energy": 0.5, "motion_energy": -1.0, "speed": -5, "motion_stddev": -0.5, "distance_jump": -5},
+    "light_movement": {"static_energy": 0.2, "motion_energy": 0.3, "movement_signs": 1.0, "speed": -10, "distance_jump": -5},
+    "walking": {"bias": -40, "motion_energy": 0.5, "movement_signs": 0.5, "speed": 25, "distance_jump": -5},
+    "several_people": {"bias": -70, "static_energy": 0.2, "motion_energy": 0.4, "movement_signs": 0.5, "motion_stddev": 0.5, "distance_jump": 25},
+}
+
+# Linear model of one class: score = bias + sum(weight * window mean of the feature)
+ACTIVITY_CLASS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_BIAS, default=0.0): cv.float_range(min=-30000.0, max=30000.0),
+        **{cv.Optional(feature, default=0.0): cv.float_range(min=-100.0, max=100.0) for feature in ACTIVITY_FEATURES},
+    }
+)
 
 
 AUTO_LOAD = ["mr24hpc1"]
@@ -40,6 +76,23 @@ CONFIG_SCHEMA = {
     cv.Optional(CONF_MOTIONSTATUS): text_sensor.text_sensor_schema(
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon="mdi:human-greeting"
     ),
+    cv.Optional(CONF_WRITESTATUS): text_sensor.text_sensor_schema(
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon="mdi:upload-network-outline"
+    ),
+    cv.Optional(CONF_REPORTSTATUS): text_sensor.text_sensor_schema(
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon="mdi:chart-timeline-variant"
+    ),
+    # Classified from the underlying open stream, changes only once a new activity won confirm_count reports in a row.
+    # Cleared when the stream is switched off, until a new activity is confirmed.
+    cv.Optional(CONF_ACTIVITY): text_sensor.text_sensor_schema(icon="mdi:human-handsup").extend(
+        {
+            cv.Optional(CONF_WINDOW_SIZE, default=10): cv.int_range(min=2, max=32),   # unit: reports
+            cv.Optional(CONF_CONFIRM_COUNT, default=3): cv.int_range(min=1, max=100),
+            cv.Optional(CONF_MODEL, default=ACTIVITY_DEFAULT_MODEL): cv.Schema(
+                {cv.Required(activity): ACTIVITY_CLASS_SCHEMA for activity in ACTIVITY_CLASSES}
+            ),
+        }
+    ),
 }
 
 
@@ -66,3 +119,26 @@ async def to_code(config):
     if motionstatus_config := config.get(CONF_MOTIONSTATUS):
         sens = await text_sensor.new_text_sensor(motionstatus_config)
         cg.add(mr24hpc1_component.set_motion_status_text_sensor(sens))
+    if writestatus_config := config.get(CONF_WRITESTATUS):
+        sens = await text_sensor.new_text_sensor(writestatus_config)
+        cg.add(mr24hpc1_component.set_write_status_text_sensor(sens))
+    if reportstatus_config := config.get(CONF_REPORTSTATUS):
+        sens = await text_sensor.new_text_sensor(reportstatus_config)
+        cg.add(mr24hpc1_component.set_report_status_text_sensor(sens))
+    if activity_config := config.get(CONF_ACTIVITY):
+        sens = await text_sensor.new_text_sensor(activity_config)
+        cg.add(mr24hpc1_component.set_activity_text_sensor(sens))
+        cg.add(
+            mr24hpc1_component.set_activity_window(
+                activity_config[CONF_WINDOW_SIZE], activity_config[CONF_CONFIRM_COUNT]
+            )
+        )
+        for index, activity in enumerate(ACTIVITY_CLASSES):
+            model = activity_config[CONF_MODEL][activity]
+            cg.add(
+                mr24hpc1_component.set_activity_class(
+                    index,
+                    round(model[CONF_BIAS] * 256),   # Q8 fixed point
+                    *[round(model[feature] * 256) for feature in ACTIVITY_FEATURES],
+                )
+            )
@@ -0,0 +1,107 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import binary_sensor, sensor
+from esphome.const import (
+    CONF_ID,
+    DEVICE_CLASS_DISTANCE,
+    DEVICE_CLASS_OCCUPANCY,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_METER,
+)
+from ..mr24hpc1 import UPDATE_INTERVAL_MS, mr24hpc1Component
+
+DEPENDENCIES = ["mr24hpc1"]
+AUTO_LOAD = ["binary_sensor", "sensor"]
+CODEOWNERS = ["@limengdu"]
+MULTI_CONF = True
+
+mr24hpc1_aggregator_ns = cg.esphome_ns.namespace("mr24hpc1_aggregator")
+# Room level view over several mr24hpc1 radars, updated from their decoded frames
+mr24hpc1AggregatorComponent = mr24hpc1_aggregator_ns.class_(
+    "mr24hpc1AggregatorComponent", cg.Component
+)
+AggregatorMode = mr24hpc1_aggregator_ns.enum("AggregatorMode")
+
+CONF_RADARS = "radars"
+CONF_MODE = "mode"
+CONF_QUORUM = "quorum"
+CONF_STALE_TIMEOUT = "stale_timeout"
+CONF_PRESENCE = "presence"
+CONF_NEAREST_DISTANCE = "nearest_distance"
+CONF_MOTION_ENERGY = "motion_energy"
+
+AGGREGATOR_MODES = {
+    "any": AggregatorMode.AGGREGATOR_MODE_ANY,
+    "all": AggregatorMode.AGGREGATOR_MODE_ALL,
+    "quorum": AggregatorMode.AGGREGATOR_MODE_QUORUM,
+}
+
+
+def validate_stale_timeout(value):
+    value = cv.positive_time_period_milliseconds(value)
+    if value.total_milliseconds <= UPDATE_INTERVAL_MS:
+        raise cv.Invalid(
+            f"{CONF_STALE_TIMEOUT} must be longer than the radar update interval of {UPDATE_INTERVAL_MS} ms, "
+            "a quiet radar only sends a heartbeat reply once per interval"
+        )
+    return value
+
+
+def validate_quorum(config):
+    if config[CONF_QUORUM] > len(config[CONF_RADARS]):
+        raise cv.Invalid(f"{CONF_QUORUM} can not be larger than the number of radars")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(mr24hpc1AggregatorComponent),
+            cv.Required(CONF_RADARS): cv.All(
+                cv.ensure_list(cv.use_id(mr24hpc1Component)), cv.Length(min=2, max=8)
+            ),
+            cv.Optional(CONF_MODE, default="any"): cv.enum(AGGREGATOR_MODES, lower=True),
+            cv.Optional(CONF_QUORUM, default=2): cv.int_range(min=1, max=8),
+            # A radar that has sent nothing, heartbeat replies included, for this long is left out of the
+            # presence vote, its distance and energy are left out once its underlying open stream is this old.
+            # A quiet radar sends a heartbeat reply once per update interval, the default rides out two lost ones.
+            cv.Optional(CONF_STALE_TIMEOUT, default="30s"): validate_stale_timeout,
+            cv.Optional(CONF_PRESENCE): binary_sensor.binary_sensor_schema(
+                device_class=DEVICE_CLASS_OCCUPANCY, icon="mdi:home-account"
+            ),
+            cv.Optional(CONF_NEAREST_DISTANCE): sensor.sensor_schema(
+                device_class=DEVICE_CLASS_DISTANCE,
+                unit_of_measurement=UNIT_METER,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                icon="mdi:signal-distance-variant",
+            ),
+            cv.Optional(CONF_MOTION_ENERGY): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                icon="mdi:counter",
+            ),
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_quorum,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    cg.add(var.set_mode(config[CONF_MODE]))
+    cg.add(var.set_quorum(config[CONF_QUORUM]))
+    cg.add(var.set_stale_timeout(config[CONF_STALE_TIMEOUT]))
+    for radar_id in config[CONF_RADARS]:
+        radar = await cg.get_variable(radar_id)
+        cg.add(var.add_radar(radar))
+    if presence_config := config.get(CONF_PRESENCE):
+        sens = await binary_sensor.new_binary_sensor(presence_config)
+        cg.add(var.set_presence_binary_sensor(sens))
+    if nearest_distance_config := config.get(CONF_NEAREST_DISTANCE):
+        sens = await sensor.new_sensor(nearest_distance_config)
+        cg.add(var.set_nearest_distance_sensor(sens))
+    if motion_energy_config := config.get(CONF_MOTION_ENERGY):
+        sens = await sensor.new_sensor(motion_energy_config)
+        cg.add(var.set_motion_energy_sensor(sens))
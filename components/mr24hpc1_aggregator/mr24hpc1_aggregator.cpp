@@ -0,0 +1,109 @@
+#include "esphome/core/log.h"
+#include "mr24hpc1_aggregator.h"
+
+#include <cinttypes>
+#include <cmath>
+
+namespace esphome {
+namespace mr24hpc1_aggregator {
+
+static const char *TAG = "mr24hpc1_aggregator";
+
+static const char *const s_mode_str[3] = {"any", "all", "quorum"};
+
+void mr24hpc1AggregatorComponent::dump_config() {
+    ESP_LOGCONFIG(TAG, "MR24HPC1 Aggregator:");
+    ESP_LOGCONFIG(TAG, "  Radars: %u", (unsigned) this->radars_.size());
+    ESP_LOGCONFIG(TAG, "  Mode: %s", s_mode_str[this->room_.get_mode()]);
+    if (this->room_.get_mode() == AGGREGATOR_MODE_QUORUM)
+    {
+        ESP_LOGCONFIG(TAG, "  Quorum: %u", this->room_.get_quorum());
+    }
+    ESP_LOGCONFIG(TAG, "  Stale timeout: %" PRIu32 " ms", this->room_.get_stale_timeout());
+    LOG_BINARY_SENSOR("  ", "PresenceBinarySensor", this->presence_binary_sensor_);
+    LOG_SENSOR("  ", "NearestDistanceSensor", this->nearest_distance_sensor_);
+    LOG_SENSOR("  ", "MotionEnergySensor", this->motion_energy_sensor_);
+}
+
+void mr24hpc1AggregatorComponent::add_radar(mr24hpc1::mr24hpc1Component *radar)
+{
+    this->radars_.push_back(radar);
+    this->room_.add_radar();
+}
+
+// Everything is driven by the radars' own frames, the interval only drops radars that went quiet
+void mr24hpc1AggregatorComponent::setup() {
+    for (size_t i = 0; i < this->radars_.size(); i++)
+    {
+        this->radars_[i]->add_on_presence_callback([this, i](bool present) { this->on_presence(i, present); });
+        this->radars_[i]->add_on_underlying_open_callback(
+            [this, i](const mr24hpc1::UnderlyingOpenFrame &frame) { this->on_underlying_open_frame(i, frame); });
+    }
+    this->set_interval("stale", STALE_CHECK_INTERVAL_MS, [this]() { this->check_stale(); });
+}
+
+void mr24hpc1AggregatorComponent::on_presence(size_t index, bool present)
+{
+    this->room_.set_presence(index, present, millis());
+    this->publish_presence();
+}
+
+void mr24hpc1AggregatorComponent::on_underlying_open_frame(size_t index, const mr24hpc1::UnderlyingOpenFrame &frame)
+{
+    uint8_t distance = frame.motion_distance ? frame.motion_distance : frame.presence_distance;
+    this->room_.set_frame(index, distance, frame.motion_energy, millis());
+    this->publish_telemetry();
+}
+
+// A radar keeps its presence vote while it answers heartbeats, also when it reports no presence change
+void mr24hpc1AggregatorComponent::check_stale(void)
+{
+    for (size_t i = 0; i < this->radars_.size(); i++)
+    {
+        uint32_t last_frame_ms = this->radars_[i]->get_last_frame_ms();
+        if (last_frame_ms != 0)
+        {
+            this->room_.seen(i, last_frame_ms);
+        }
+    }
+    this->publish_presence();
+    this->publish_telemetry();
+}
+
+void mr24hpc1AggregatorComponent::publish_presence(void)
+{
+    bool occupied = this->room_.occupied(millis());
+    if (occupied == this->presence_published_)
+        return;
+    this->presence_published_ = occupied;
+    if (this->presence_binary_sensor_ != nullptr)
+    {
+        this->presence_binary_sensor_->publish_state(occupied);
+    }
+}
+
+void mr24hpc1AggregatorComponent::publish_telemetry(void)
+{
+    uint32_t now = millis();
+    int16_t distance = this->room_.nearest_distance(now);
+    int16_t motion_energy = this->room_.motion_energy(now);
+    if (distance != this->distance_published_)
+    {
+        this->distance_published_ = distance;
+        if (this->nearest_distance_sensor_ != nullptr)
+        {
+            this->nearest_distance_sensor_->publish_state(distance ? distance * 0.5f : NAN);
+        }
+    }
+    if (motion_energy != this->motion_energy_published_)
+    {
+        this->motion_energy_published_ = motion_energy;
+        if (this->motion_energy_sensor_ != nullptr)
+        {
+            this->motion_energy_sensor_->publish_state(motion_energy);
+        }
+    }
+}
+
+}  // namespace mr24hpc1_aggregator
+}  // namespace esphome
@@ -0,0 +1,44 @@
+#pragma once
+#include "esphome/core/component.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/mr24hpc1/mr24hpc1.h"
+#include "room_aggregate.h"
+
+#include <vector>
+
+namespace esphome {
+namespace mr24hpc1_aggregator {
+
+#define STALE_CHECK_INTERVAL_MS 1000
+
+class mr24hpc1AggregatorComponent : public Component {
+  SUB_BINARY_SENSOR(presence)
+  SUB_SENSOR(nearest_distance)
+  SUB_SENSOR(motion_energy)
+
+  public:
+    float get_setup_priority() const override { return esphome::setup_priority::DATA; }
+    void setup() override;
+    void dump_config() override;
+    void add_radar(mr24hpc1::mr24hpc1Component *radar);
+    void set_mode(AggregatorMode mode) { this->room_.set_mode(mode); }
+    void set_quorum(uint8_t quorum) { this->room_.set_quorum(quorum); }
+    void set_stale_timeout(uint32_t stale_timeout) { this->room_.set_stale_timeout(stale_timeout); }
+
+  protected:
+    void on_presence(size_t index, bool present);
+    void on_underlying_open_frame(size_t index, const mr24hpc1::UnderlyingOpenFrame &frame);
+    void check_stale(void);
+    void publish_presence(void);
+    void publish_telemetry(void);
+
+    std::vector<mr24hpc1::mr24hpc1Component *> radars_;
+    RoomAggregate room_;
+    int8_t presence_published_{-1};   // -1 = nothing published yet
+    int16_t distance_published_{-1};
+    int16_t motion_energy_published_{-1};
+};
+
+}  // namespace mr24hpc1_aggregator
+}  // namespace esphome
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace mr24hpc1_aggregator {
+
+enum AggregatorMode : uint8_t
+{
+    AGGREGATOR_MODE_ANY,      // occupied when one radar sees someone
+    AGGREGATOR_MODE_ALL,      // occupied when every radar sees someone
+    AGGREGATOR_MODE_QUORUM,   // occupied when at least quorum radars see someone
+};
+
+// Last decoded state of one radar, every radar updates its own slot on its own schedule
+struct RadarState
+{
+    bool present;
+    uint8_t distance;         // nearest target, 0.5 m steps, 0 = none
+    uint8_t motion_energy;
+    uint32_t last_seen_ms;    // last valid frame of any kind, heartbeat replies included, 0 = never
+    uint32_t last_frame_ms;   // last underlying open frame, 0 = never
+};
+
+// Room level view over the states of several radars. A radar that has not sent anything for the stale
+// timeout is left out of the presence vote, so one that went silent while present cannot hold the room
+// occupied. Its distance and energy are left out once its underlying open stream is stale.
+class RoomAggregate
+{
+  public:
+    void set_mode(AggregatorMode mode) { this->mode_ = mode; }
+    void set_quorum(uint8_t quorum) { this->quorum_ = quorum; }
+    void set_stale_timeout(uint32_t stale_timeout) { this->stale_timeout_ = stale_timeout; }
+    AggregatorMode get_mode() const { return this->mode_; }
+    uint8_t get_quorum() const { return this->quorum_; }
+    uint32_t get_stale_timeout() const { return this->stale_timeout_; }
+
+    size_t add_radar()
+    {
+        this->states_.push_back(RadarState{});
+        return this->states_.size() - 1;
+    }
+    size_t size() const { return this->states_.size(); }
+
+    void seen(size_t index, uint32_t now) { this->states_[index].last_seen_ms = stamp(now); }
+
+    void set_presence(size_t index, bool present, uint32_t now)
+    {
+        this->states_[index].present = present;
+        this->seen(index, now);
+    }
+
+    void set_frame(size_t index, uint8_t distance, uint8_t motion_energy, uint32_t now)
+    {
+        RadarState &state = this->states_[index];
+        state.distance = distance;
+        state.motion_energy = motion_energy;
+        state.last_frame_ms = stamp(now);
+        state.last_seen_ms = state.last_frame_ms;
+    }
+
+    // Only radars that are still reporting vote, all of them have to see someone in AGGREGATOR_MODE_ALL
+    bool occupied(uint32_t now) const
+    {
+        uint8_t voters = 0;
+        uint8_t present = 0;
+        for (const RadarState &state : this->states_)
+        {
+            if (!this->is_fresh(state.last_seen_ms, now))
+                continue;
+            voters++;
+            present += state.present;
+        }
+        switch (this->mode_)
+        {
+            case AGGREGATOR_MODE_ALL:
+                return voters > 0 && present == voters;
+            case AGGREGATOR_MODE_QUORUM:
+                return present >= this->quorum_;
+            default:
+                return present > 0;
+        }
+    }
+
+    // Nearest target over all radars with fresh telemetry, 0 = none
+    uint8_t nearest_distance(uint32_t now) const
+    {
+        uint8_t distance = 0;
+        for (const RadarState &state : this->states_)
+        {
+            if (!this->is_fresh(state.last_frame_ms, now))
+                continue;
+            if (state.distance != 0 && (distance == 0 || state.distance < distance))
+                distance = state.distance;
+        }
+        return distance;
+    }
+
+    // Combined motion energy is the strongest one
+    uint8_t motion_energy(uint32_t now) const
+    {
+        uint8_t motion_energy = 0;
+        for (const RadarState &state : this->states_)
+        {
+            if (this->is_fresh(state.last_frame_ms, now) && state.motion_energy > motion_energy)
+                motion_energy = state.motion_energy;
+        }
+        return motion_energy;
+    }
+
+  protected:
+    static uint32_t stamp(uint32_t now) { return now == 0 ? 1 : now; }   // 0 is reserved for "never reported"
+
+    bool is_fresh(uint32_t last_ms, uint32_t now) const
+    {
+        return last_ms != 0 && (now - last_ms) <= this->stale_timeout_;
+    }
+
+    std::vector<RadarState> states_;
+    AggregatorMode mode_{AGGREGATOR_MODE_ANY};
+    uint8_t quorum_{2};
+    uint32_t stale_timeout_{30000};
+};
+
+}  // namespace mr24hpc1_aggregator
+}  // namespace esphome
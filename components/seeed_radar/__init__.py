@@ -0,0 +1,7 @@
+import esphome.config_validation as cv
+
+# Header-only framing engine shared by the Seeed Studio mmWave radar components.
+# It has no configuration of its own, radar components pull it in with AUTO_LOAD.
+CODEOWNERS = ["@limengdu"]
+
+CONFIG_SCHEMA = cv.Schema({})
@@ -0,0 +1,199 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace seeed_radar {
+
+// Seeed Studio mmWave UART frame, shared by the MR24HPC1, the 60 GHz breathing/heart rate and the fall detection radars:
+//   0x53 0x59 | control word | command word | data length (2 bytes, big endian) | data | checksum | 0x54 0x43
+// The checksum is the low byte of the sum of every byte before it.
+static constexpr uint8_t FRAME_HEADER1 = 0x53;
+static constexpr uint8_t FRAME_HEADER2 = 0x59;
+static constexpr uint8_t FRAME_TAIL1 = 0x54;
+static constexpr uint8_t FRAME_TAIL2 = 0x43;
+
+static constexpr size_t FRAME_CONTROL_INDEX = 2;
+static constexpr size_t FRAME_COMMAND_INDEX = 3;
+static constexpr size_t FRAME_LENGTH_INDEX = 4;
+static constexpr size_t FRAME_DATA_INDEX = 6;
+static constexpr size_t FRAME_OVERHEAD = 9;   // header, control, command, length, checksum and tail
+
+inline uint8_t frame_checksum(const uint8_t *frame, size_t len)
+{
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        sum += frame[i];
+    }
+    return sum;
+}
+
+// Build a complete frame into out, which must hold data_len + FRAME_OVERHEAD bytes. Returns the frame length.
+inline size_t build_frame(uint8_t *out, uint8_t control, uint8_t command, const uint8_t *data, uint16_t data_len)
+{
+    out[0] = FRAME_HEADER1;
+    out[1] = FRAME_HEADER2;
+    out[FRAME_CONTROL_INDEX] = control;
+    out[FRAME_COMMAND_INDEX] = command;
+    out[FRAME_LENGTH_INDEX] = data_len >> 8;
+    out[FRAME_LENGTH_INDEX + 1] = data_len & 0xFF;
+    for (uint16_t i = 0; i < data_len; i++)
+    {
+        out[FRAME_DATA_INDEX + i] = data[i];
+    }
+    size_t len = FRAME_DATA_INDEX + data_len;
+    out[len] = frame_checksum(out, len);
+    out[len + 1] = FRAME_TAIL1;
+    out[len + 2] = FRAME_TAIL2;
+    return len + 3;
+}
+
+// Byte at a time frame splitter with a running checksum. The radar component derives from it and
+// is the decoder policy (CRTP), so every hook is resolved at compile time and inlined:
+//   void on_frame(uint8_t *frame, size_t len);   every frame with a valid checksum, required
+//   void on_frame_start();                       header byte seen, optional
+//   void on_frame_received();                    tail received, before the checksum is compared, optional
+//   void on_frame_error(const char *reason, uint8_t value);   optional
+// A decoder that keeps its hooks private declares the engine a friend.
+template<typename Decoder, uint16_t MaxDataLen = 32> class FrameEngine
+{
+  public:
+    void feed(uint8_t value)
+    {
+        switch (this->state_)
+        {
+            case STATE_IDLE:
+                if (value == FRAME_HEADER1)
+                {
+                    this->decoder_().on_frame_start();
+                    this->state_ = STATE_HEADER2;
+                }
+                break;
+            case STATE_HEADER2:
+                if (value == FRAME_HEADER2)
+                {
+                    this->buf_[0] = FRAME_HEADER1;
+                    this->buf_[1] = FRAME_HEADER2;
+                    this->len_ = 2;
+                    this->sum_ = FRAME_HEADER1 + FRAME_HEADER2;
+                    this->state_ = STATE_CONTROL;
+                }
+                else
+                {
+                    this->fail_("header", value);
+                }
+                break;
+            case STATE_CONTROL:
+            case STATE_COMMAND:
+                this->push_(value);
+                this->state_++;
+                break;
+            case STATE_LENGTH_H:
+                this->data_left_ = value << 8;
+                this->push_(value);
+                this->state_ = STATE_LENGTH_L;
+                break;
+            case STATE_LENGTH_L:
+                this->data_left_ |= value;
+                if (this->data_left_ > MaxDataLen)
+                {
+                    this->fail_("length", value);
+                    break;
+                }
+                this->push_(value);
+                this->state_ = this->data_left_ ? STATE_DATA : STATE_CHECKSUM;
+                break;
+            case STATE_DATA:
+                this->push_(value);
+                if (--this->data_left_ == 0)
+                {
+                    this->state_ = STATE_CHECKSUM;
+                }
+                break;
+            case STATE_CHECKSUM:
+                this->buf_[this->len_++] = value;
+                this->state_ = STATE_TAIL1;
+                break;
+            case STATE_TAIL1:
+                if (value == FRAME_TAIL1)
+                {
+                    this->state_ = STATE_TAIL2;
+                }
+                else
+                {
+                    this->fail_("tail", value);
+                }
+                break;
+            case STATE_TAIL2:
+                if (value != FRAME_TAIL2)
+                {
+                    this->fail_("tail", value);
+                    break;
+                }
+                this->buf_[this->len_++] = FRAME_TAIL1;
+                this->buf_[this->len_++] = FRAME_TAIL2;
+                this->state_ = STATE_IDLE;
+                this->decoder_().on_frame_received();
+                if (this->buf_[this->len_ - 3] == this->sum_)
+                {
+                    this->decoder_().on_frame(this->buf_, this->len_);
+                }
+                else
+                {
+                    this->decoder_().on_frame_error("checksum", this->buf_[this->len_ - 3]);
+                }
+                break;
+            default:
+                this->state_ = STATE_IDLE;
+                break;
+        }
+    }
+
+    // Drop a partially received frame
+    void reset_frame() { this->state_ = STATE_IDLE; }
+
+  protected:
+    // Default hooks, hidden by the decoder when it wants them
+    void on_frame_start() {}
+    void on_frame_received() {}
+    void on_frame_error(const char *reason, uint8_t value) {}
+
+  private:
+    enum : uint8_t
+    {
+        STATE_IDLE,
+        STATE_HEADER2,
+        STATE_CONTROL,
+        STATE_COMMAND,
+        STATE_LENGTH_H,
+        STATE_LENGTH_L,
+        STATE_DATA,
+        STATE_CHECKSUM,
+        STATE_TAIL1,
+        STATE_TAIL2,
+    };
+
+    Decoder &decoder_() { return *static_cast<Decoder *>(this); }
+
+    void push_(uint8_t value)
+    {
+        this->buf_[this->len_++] = value;
+        this->sum_ += value;
+    }
+
+    void fail_(const char *reason, uint8_t value)
+    {
+        this->state_ = STATE_IDLE;
+        this->decoder_().on_frame_error(reason, value);
+    }
+
+    uint8_t buf_[MaxDataLen + FRAME_OVERHEAD];
+    uint8_t state_{STATE_IDLE};
+    uint8_t sum_{0};
+    uint16_t len_{0};
+    uint16_t data_left_{0};
+};
+
+}  // namespace seeed_radar
+}  // namespace esphome
@@ -0,0 +1,97 @@
+// Idle cost of the component: what a quiet radar costs the main loop, per instance,
+// with loop() sleeping and with it running on every main loop iteration like before
+#include "harness.h"
+#include "host_radar.h"
+
+#include <memory>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::host;
+
+#define BENCH_RADARS 4
+#define BENCH_IDLE_MS 60000
+
+struct IdleCost
+{
+    double loops_per_s;
+    double callbacks_per_s;
+    double available_per_s;
+    double cpu_us_per_s;
+};
+
+static IdleCost measure_idle(bool loop_always)
+{
+    TempPreferences preferences;
+    std::vector<std::unique_ptr<Instance>> instances;
+    uint64_t available_calls = 0;
+    g_core.clear();
+    g_core.set_loop_always(loop_always);
+    for (uint8_t i = 0; i < BENCH_RADARS; i++)
+    {
+        instances.emplace_back(new Instance());
+        instances.back()->radar.set_preference_hash(i + 1);
+        g_core.add(&instances.back()->radar);
+    }
+    g_core.run(HOST_WARMUP_MS);
+    for (auto &instance : instances)
+        available_calls -= instance->radar.host_available_calls();
+    g_core.reset_stats();
+    g_core.run(BENCH_IDLE_MS);
+    for (auto &instance : instances)
+    {
+        available_calls += instance->radar.host_available_calls();
+        CHECK(instance->simulated.get_heartbeats() > 0);
+        CHECK(instance->entities.heartbeat.state == "Normal");
+    }
+
+    const Stats &stats = g_core.stats();
+    double seconds_instances = BENCH_IDLE_MS / 1000.0 * BENCH_RADARS;
+    IdleCost cost;
+    cost.loops_per_s = stats.loops / seconds_instances;
+    cost.callbacks_per_s = stats.callbacks / seconds_instances;
+    cost.available_per_s = available_calls / seconds_instances;
+    cost.cpu_us_per_s = stats.cpu_ns / 1000.0 / seconds_instances;
+    printf("%-15s loop() %6.2f/s, timers %6.2f/s, available() %7.2f/s, %7.2f us CPU/s per instance\n",
+           loop_always ? "loop always:" : "loop sleeping:", cost.loops_per_s, cost.callbacks_per_s, cost.available_per_s,
+           cost.cpu_us_per_s);
+    g_core.clear();
+    return cost;
+}
+
+// The fused presence is held after the last evidence and released by a timer, loop() sleeps meanwhile
+static void test_fusion_hold_sleeps()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    instance.radar.set_fused_presence_binary_sensor(&instance.entities.fused_presence);
+    instance.radar.configure_presence_fusion(20, 40, 5, 5, 0, 5000);
+    scenario.start();
+
+    instance.simulated.report_presence(true);
+    g_core.run(200);
+    CHECK(instance.entities.fused_presence.state);
+    instance.simulated.report_presence(false);
+    g_core.reset_stats();
+    g_core.run(4000);
+    CHECK(instance.entities.fused_presence.state);   // Still held
+    CHECK(g_core.stats().loops < 4000 / HOST_LOOP_INTERVAL_MS / 4);
+    g_core.run(1500);
+    CHECK(!instance.entities.fused_presence.state);
+}
+
+int main()
+{
+    IdleCost always = measure_idle(true);
+    IdleCost sleeping = measure_idle(false);
+    // Without loop sleeping every main loop iteration calls loop(), sleeping it only runs for the
+    // radar traffic: a heartbeat and a query step per update interval
+    CHECK(always.loops_per_s > 1000.0 / HOST_LOOP_INTERVAL_MS - 1);
+    CHECK(sleeping.loops_per_s < 2);
+    // While asleep the UART is checked by the rx poll, 20 times a second by default, the few loop()
+    // runs check it too. The timers are the rx poll and update().
+    CHECK(sleeping.available_per_s < 1000.0 / 50 + 10);
+    CHECK(sleeping.callbacks_per_s < 1000.0 / 50 + 2);
+    test_fusion_hold_sleeps();
+    return test_result("bench_idle_loop");
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdio>
+
+// Minimal assertion helpers for the host tests, each test is its own executable run by ctest
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do \
+    { \
+        long long actual_ = (long long) (actual); \
+        long long expected_ = (long long) (expected); \
+        if (actual_ != expected_) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, \
+                    actual_, expected_); \
+            g_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do \
+    { \
+        double actual_ = (double) (actual); \
+        double expected_ = (double) (expected); \
+        if (actual_ < expected_ - (tolerance) || actual_ > expected_ + (tolerance)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g not within %g of %g\n", __FILE__, __LINE__, #actual, \
+                    #expected, actual_, (double) (tolerance), expected_); \
+            g_failures++; \
+        } \
+    } while (0)
+
+static int test_result(const char *name)
+{
+    if (g_failures == 0)
+        printf("%s: passed\n", name);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#pragma once
+// A complete mr24hpc1 component on the host core (tests/host/stubs): every entity wired, a file-backed
+// preference store and a simulated radar on the other end of the UART that answers like the firmware
+#include "mr24hpc1/mr24hpc1.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace esphome {
+namespace host {
+
+class SimulatedRadar : public seeed_radar::FrameEngine<SimulatedRadar>
+{
+  public:
+    explicit SimulatedRadar(uart::UARTDevice *uart) : uart_(uart)
+    {
+        uart->host_set_transmit([this](const uint8_t *data, size_t len) {
+            for (size_t i = 0; i < len; i++)
+                this->feed(data[i]);
+        });
+    }
+
+    void send(uint8_t control, uint8_t command, const uint8_t *data, uint16_t len)
+    {
+        uint8_t frame[64];
+        size_t frame_len = seeed_radar::build_frame(frame, control, command, data, len);
+        this->uart_->host_receive(frame, frame_len);
+    }
+    void send(uint8_t control, uint8_t command, uint8_t value) { this->send(control, command, &value, 1); }
+
+    // Active reports
+    void report_presence(bool present)
+    {
+        this->present_ = present;
+        this->send(0x80, 0x01, present);
+    }
+    void report_underlying(uint8_t static_energy, uint8_t presence_distance, uint8_t motion_energy, uint8_t motion_distance,
+                           uint8_t motion_speed)
+    {
+        const uint8_t data[5] = {static_energy, presence_distance, motion_energy, motion_distance, motion_speed};
+        this->send(0x08, 0x01, data, sizeof(data));
+    }
+
+    uint32_t get_requests() const { return this->requests_; }
+    uint32_t get_heartbeats() const { return this->heartbeats_; }
+    void set_silent(bool silent) { this->silent_ = silent; }
+
+    void on_frame(uint8_t *frame, size_t len)
+    {
+        uint8_t control = frame[FRAME_CONTROL_WORD_INDEX];
+        uint8_t command = frame[FRAME_COMMAND_WORD_INDEX];
+        uint8_t value = frame[FRAME_DATA_INDEX];
+        this->requests_++;
+        if (this->silent_)
+            return;
+        if (control == 0x01 && command == 0x01)
+        {
+            this->heartbeats_++;
+            this->send(control, command, 0x0F);
+        }
+        else if (control == 0x02 && command >= 0xA1 && command <= 0xA4)
+        {
+            static const char *const product[4] = {"MR24HPC1", "1", "G24VD1SYV001003", "G24VD1SYV000009"};
+            const char *text = product[command - 0xA1];
+            this->send(control, command, (const uint8_t *) text, strlen(text));
+        }
+        else if (control == 0x08 && (command == 0x00 || command == 0x80))
+        {
+            if (command == 0x00)
+                this->underlying_open_ = value;
+            this->send(control, command, this->underlying_open_);
+        }
+        else if (control == 0x80 && command == 0x81)
+        {
+            this->send(control, command, this->present_);
+        }
+        else if (command >= 0x80)
+        {
+            this->send(control, command, 0x00);   // Any other query reads back a default
+        }
+        else
+        {
+            this->send(control, command, value);  // A setting write is echoed
+        }
+    }
+
+  protected:
+    uart::UARTDevice *uart_;
+    uint32_t requests_{0};
+    uint32_t heartbeats_{0};
+    bool present_{false};
+    uint8_t underlying_open_{0};
+    bool silent_{false};
+};
+
+// Every entity the component can publish to
+struct Entities
+{
+    text_sensor::TextSensor heartbeat, product_model, product_id, hardware_model, firmware_version, keep_away,
+        motion_status, write_status, report_status, activity;
+    binary_sensor::BinarySensor someone_exists, fused_presence;
+    sensor::Sensor presence_distance, movement_signs, motion_distance, static_energy, motion_energy, motion_speed;
+    switch_::Switch underlying_open;
+    select::Select scene_mode;
+
+    void wire(mr24hpc1::mr24hpc1Component *radar)
+    {
+        radar->set_heartbeat_state_text_sensor(&this->heartbeat);
+        radar->set_product_model_text_sensor(&this->product_model);
+        radar->set_product_id_text_sensor(&this->product_id);
+        radar->set_hardware_model_text_sensor(&this->hardware_model);
+        radar->set_firware_version_text_sensor(&this->firmware_version);
+        radar->set_keep_away_text_sensor(&this->keep_away);
+        radar->set_motion_status_text_sensor(&this->motion_status);
+        radar->set_write_status_text_sensor(&this->write_status);
+        radar->set_report_status_text_sensor(&this->report_status);
+        radar->set_someoneExists_binary_sensor(&this->someone_exists);
+        radar->set_custom_presence_of_detection_sensor(&this->presence_distance);
+        radar->set_movementSigns_sensor(&this->movement_signs);
+        radar->set_custom_motion_distance_sensor(&this->motion_distance);
+        radar->set_custom_spatial_static_value_sensor(&this->static_energy);
+        radar->set_custom_spatial_motion_value_sensor(&this->motion_energy);
+        radar->set_custom_motion_speed_sensor(&this->motion_speed);
+        radar->set_underly_open_function_switch(&this->underlying_open);
+        this->scene_mode.options = 4;
+        radar->set_scene_mode_select(&this->scene_mode);
+    }
+};
+
+// Preferences of one test run, in a fresh directory
+class TempPreferences
+{
+  public:
+    TempPreferences()
+    {
+        strcpy(this->dir_, "/tmp/mr24hpc1_host_XXXXXX");
+        if (mkdtemp(this->dir_) == nullptr)
+            abort();
+        this->store_ = new ESPPreferences(this->dir_);
+        global_preferences = this->store_;
+    }
+    ~TempPreferences()
+    {
+        global_preferences = nullptr;
+        delete this->store_;
+        std::string cleanup = std::string("rm -rf ") + this->dir_;
+        (void) !system(cleanup.c_str());
+    }
+
+  protected:
+    char dir_[32];
+    ESPPreferences *store_;
+};
+
+#define HOST_WARMUP_MS 30000   // Power-up query sequence and capability probing
+
+// One component with every entity wired and a simulated radar on its UART
+struct Instance
+{
+    mr24hpc1::mr24hpc1Component radar;
+    Entities entities;
+    SimulatedRadar simulated{&radar};
+
+    Instance() { this->entities.wire(&this->radar); }
+};
+
+// One instance on a cleared host core with preferences of its own. Configure the instance, then
+// start() sets it up and runs it through the power-up warmup.
+class Scenario
+{
+  public:
+    Scenario() { g_core.clear(); }
+    ~Scenario() { g_core.clear(); }
+
+    void start()
+    {
+        g_core.add(&this->instance.radar);
+        g_core.run(HOST_WARMUP_MS);
+    }
+
+    TempPreferences preferences;
+    Instance instance;
+};
+
+}  // namespace host
+}  // namespace esphome
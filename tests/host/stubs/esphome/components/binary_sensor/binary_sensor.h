@@ -0,0 +1,35 @@
+#pragma once
+// Host entity, keeps the last published state
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor
+{
+  public:
+    void publish_state(bool state)
+    {
+        this->state = state;
+        this->has_state_ = true;
+        this->publishes++;
+    }
+    bool has_state() const { return this->has_state_; }
+
+    bool state{};
+    uint32_t publishes{0};
+
+  protected:
+    bool has_state_{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
+
+#define SUB_BINARY_SENSOR(name) \
+  protected: \
+    binary_sensor::BinarySensor *name##_binary_sensor_{nullptr}; \
+\
+  public: \
+    void set_##name##_binary_sensor(binary_sensor::BinarySensor *binary_sensor) { this->name##_binary_sensor_ = binary_sensor; }
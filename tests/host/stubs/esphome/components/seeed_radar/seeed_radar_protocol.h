@@ -0,0 +1,3 @@
+#pragma once
+// The real frame engine, the components directory is on the include path
+#include "seeed_radar/seeed_radar_protocol.h"
@@ -0,0 +1,35 @@
+#pragma once
+// Host entity with a fixed option count, keeps the last published state
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace select {
+
+class Select
+{
+  public:
+    virtual ~Select() = default;
+    void publish_state(const std::string &state)
+    {
+        this->state = state;
+        this->publishes++;
+    }
+    bool has_index(size_t index) const { return index < this->options; }
+    bool has_state() const { return this->publishes != 0; }
+
+    std::string state;
+    size_t options{0};
+    uint32_t publishes{0};
+};
+
+}  // namespace select
+}  // namespace esphome
+
+#define SUB_SELECT(name) \
+  protected: \
+    select::Select *name##_select_{nullptr}; \
+\
+  public: \
+    void set_##name##_select(select::Select *s) { this->name##_select_ = s; }
@@ -0,0 +1,35 @@
+#pragma once
+// Host entity, keeps the last published state
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace sensor {
+
+class Sensor
+{
+  public:
+    void publish_state(float state)
+    {
+        this->state = state;
+        this->has_state_ = true;
+        this->publishes++;
+    }
+    bool has_state() const { return this->has_state_; }
+
+    float state{};
+    uint32_t publishes{0};
+
+  protected:
+    bool has_state_{false};
+};
+
+}  // namespace sensor
+}  // namespace esphome
+
+#define SUB_SENSOR(name) \
+  protected: \
+    sensor::Sensor *name##_sensor_{nullptr}; \
+\
+  public: \
+    void set_##name##_sensor(sensor::Sensor *sensor) { this->name##_sensor_ = sensor; }
@@ -0,0 +1,69 @@
+#pragma once
+// Host socket: the POSIX socket calls like ESPHome's BSD socket implementation. A test can cap the
+// bytes one write() accepts to provoke partial writes.
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace esphome {
+namespace socket {
+
+inline size_t &host_write_limit()
+{
+    static size_t limit = 0;   // 0 = no limit
+    return limit;
+}
+
+class Socket
+{
+  public:
+    explicit Socket(int fd) : fd_(fd) {}
+    ~Socket() { this->close(); }
+
+    int connect(const struct sockaddr *addr, socklen_t addrlen) { return ::connect(this->fd_, addr, addrlen); }
+    ssize_t write(const void *buf, size_t len)
+    {
+        size_t limit = host_write_limit();
+        return ::send(this->fd_, buf, limit != 0 && len > limit ? limit : len, MSG_NOSIGNAL);
+    }
+    int setblocking(bool blocking)
+    {
+        int flags = fcntl(this->fd_, F_GETFL, 0);
+        return fcntl(this->fd_, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+    }
+    int close()
+    {
+        int ret = this->fd_ < 0 ? 0 : ::close(this->fd_);
+        this->fd_ = -1;
+        return ret;
+    }
+
+  protected:
+    int fd_;
+};
+
+inline std::unique_ptr<Socket> socket_ip(int type, int protocol)
+{
+    int fd = ::socket(AF_INET, type, protocol);
+    if (fd < 0)
+        return nullptr;
+    return std::unique_ptr<Socket>(new Socket(fd));
+}
+
+inline socklen_t set_sockaddr(struct sockaddr *addr, socklen_t addrlen, const std::string &ip_address, uint16_t port)
+{
+    struct sockaddr_in *server = (struct sockaddr_in *) addr;
+    memset(server, 0, sizeof(*server));
+    server->sin_family = AF_INET;
+    server->sin_port = htons(port);
+    inet_pton(AF_INET, ip_address.c_str(), &server->sin_addr);
+    return sizeof(*server);
+}
+
+}  // namespace socket
+}  // namespace esphome
@@ -0,0 +1,30 @@
+#pragma once
+// Host entity, keeps the last published state
+#include <cstdint>
+
+namespace esphome {
+namespace switch_ {
+
+class Switch
+{
+  public:
+    virtual ~Switch() = default;
+    void publish_state(bool state)
+    {
+        this->state = state;
+        this->publishes++;
+    }
+
+    bool state{false};
+    uint32_t publishes{0};
+};
+
+}  // namespace switch_
+}  // namespace esphome
+
+#define SUB_SWITCH(name) \
+  protected: \
+    switch_::Switch *name##_switch_{nullptr}; \
+\
+  public: \
+    void set_##name##_switch(switch_::Switch *s) { this->name##_switch_ = s; }
@@ -0,0 +1,35 @@
+#pragma once
+// Host entity, keeps the last published state
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor
+{
+  public:
+    void publish_state(std::string state)
+    {
+        this->state = state;
+        this->has_state_ = true;
+        this->publishes++;
+    }
+    bool has_state() const { return this->has_state_; }
+
+    std::string state{};
+    uint32_t publishes{0};
+
+  protected:
+    bool has_state_{false};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
+
+#define SUB_TEXT_SENSOR(name) \
+  protected: \
+    text_sensor::TextSensor *name##_text_sensor_{nullptr}; \
+\
+  public: \
+    void set_##name##_text_sensor(text_sensor::TextSensor *text_sensor) { this->name##_text_sensor_ = text_sensor; }
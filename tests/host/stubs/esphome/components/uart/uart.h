@@ -0,0 +1,59 @@
+#pragma once
+// Host UART: the test feeds the receive buffer and gets every transmitted chunk
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+class UARTDevice
+{
+  public:
+    int available()
+    {
+        this->available_calls_++;
+        return (int) this->rx_.size();
+    }
+    bool read_byte(uint8_t *data)
+    {
+        if (this->rx_.empty())
+            return false;
+        *data = this->rx_.front();
+        this->rx_.pop_front();
+        return true;
+    }
+    bool read_array(uint8_t *data, size_t len)
+    {
+        if (this->rx_.size() < len)
+            return false;
+        for (size_t i = 0; i < len; i++)
+            this->read_byte(&data[i]);
+        return true;
+    }
+    void write_array(const uint8_t *data, size_t len)
+    {
+        if (this->transmit_)
+            this->transmit_(data, len);
+    }
+    void write_byte(uint8_t data) { this->write_array(&data, 1); }
+    void write(uint8_t data) { this->write_array(&data, 1); }
+    void flush() {}
+    void check_uart_settings(uint32_t baud_rate) {}
+
+    // Test side
+    void host_receive(const uint8_t *data, size_t len) { this->rx_.insert(this->rx_.end(), data, data + len); }
+    void host_set_transmit(std::function<void(const uint8_t *, size_t)> &&transmit) { this->transmit_ = std::move(transmit); }
+    uint64_t host_available_calls() const { return this->available_calls_; }
+
+  protected:
+    std::deque<uint8_t> rx_;
+    std::function<void(const uint8_t *, size_t)> transmit_;
+    uint64_t available_calls_{0};
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,167 @@
+#pragma once
+// Host web server: requests are built by the test and handed to the handlers, responses and events are
+// recorded instead of sent
+#include "esphome/core/component.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum WebRequestMethod
+{
+    HTTP_GET = 1,
+    HTTP_POST = 2,
+};
+
+class AsyncWebParameter
+{
+  public:
+    explicit AsyncWebParameter(const std::string &value) : value_(value) {}
+    const std::string &value() const { return this->value_; }
+
+  protected:
+    std::string value_;
+};
+
+class AsyncWebServerResponse
+{
+  public:
+    virtual ~AsyncWebServerResponse() = default;
+    void addHeader(const char *name, const char *value) {}
+
+    int code{200};
+    std::string content_type;
+    std::string body;
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse
+{
+  public:
+    void print(const char *text) { this->body += text; }
+    __attribute__((format(printf, 2, 3))) void printf(const char *format, ...)
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        this->body += buffer;
+    }
+};
+
+class AsyncWebServerRequest
+{
+  public:
+    AsyncWebServerRequest(WebRequestMethod method, const std::string &url, const std::map<std::string, std::string> &params = {})
+        : method_(method), url_(url)
+    {
+        for (const auto &param : params)
+            this->params_.emplace(param.first, AsyncWebParameter(param.second));
+    }
+
+    std::string url() const { return this->url_; }
+    WebRequestMethod method() const { return this->method_; }
+    bool hasParam(const std::string &name) const { return this->params_.count(name) != 0; }
+    AsyncWebParameter *getParam(const std::string &name) { return &this->params_.at(name); }
+
+    AsyncResponseStream *beginResponseStream(const char *content_type)
+    {
+        this->stream_.reset(new AsyncResponseStream());
+        this->stream_->content_type = content_type;
+        return this->stream_.get();
+    }
+    void send(AsyncWebServerResponse *response)
+    {
+        this->response = *response;
+        this->responded = true;
+    }
+    void send(int code, const char *content_type, const std::string &body)
+    {
+        this->response.code = code;
+        this->response.content_type = content_type;
+        this->response.body = body;
+        this->responded = true;
+    }
+
+    AsyncWebServerResponse response;
+    bool responded{false};
+
+  protected:
+    WebRequestMethod method_;
+    std::string url_;
+    std::map<std::string, AsyncWebParameter> params_;
+    std::unique_ptr<AsyncResponseStream> stream_;
+};
+
+class AsyncWebHandler
+{
+  public:
+    virtual ~AsyncWebHandler() = default;
+    virtual bool canHandle(AsyncWebServerRequest *request) const { return false; }
+    virtual void handleRequest(AsyncWebServerRequest *request) {}
+};
+
+// A test sets the number of connected viewers, every sent event is kept
+class AsyncEventSource : public AsyncWebHandler
+{
+  public:
+    struct Event
+    {
+        std::string message;
+        std::string event;
+        uint32_t id;
+    };
+
+    explicit AsyncEventSource(const std::string &url) : url_(url) {}
+    bool canHandle(AsyncWebServerRequest *request) const override
+    {
+        return request->method() == HTTP_GET && request->url() == this->url_;
+    }
+    void send(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0)
+    {
+        this->sent.push_back(Event{message, event == nullptr ? "" : event, id});
+    }
+    size_t count() const { return this->clients; }
+    const std::string &url() const { return this->url_; }
+
+    size_t clients{0};
+    std::vector<Event> sent;
+
+  protected:
+    std::string url_;
+};
+
+namespace esphome {
+namespace web_server_base {
+
+class WebServerBase : public Component
+{
+  public:
+    void init() { this->initialized_ = true; }
+    void add_handler(AsyncWebHandler *handler) { this->handlers.push_back(handler); }
+
+    // Like the server: the first handler that can handle the request gets it, false when none can
+    bool host_request(AsyncWebServerRequest *request)
+    {
+        for (AsyncWebHandler *handler : this->handlers)
+        {
+            if (handler->canHandle(request))
+            {
+                handler->handleRequest(request);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<AsyncWebHandler *> handlers;
+
+  protected:
+    bool initialized_{false};
+};
+
+}  // namespace web_server_base
+}  // namespace esphome
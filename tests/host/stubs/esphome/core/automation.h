@@ -0,0 +1,28 @@
+#pragma once
+#include <functional>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+template<typename... Ts> class Trigger
+{
+  public:
+    void trigger(Ts... x)
+    {
+        if (this->callback_)
+            this->callback_(x...);
+    }
+    void set_callback(std::function<void(Ts...)> &&callback) { this->callback_ = std::move(callback); }
+
+  protected:
+    std::function<void(Ts...)> callback_;
+};
+
+template<typename... Ts> class Action
+{
+  public:
+    virtual ~Action() = default;
+    virtual void play(Ts... x) = 0;
+};
+
+}  // namespace esphome
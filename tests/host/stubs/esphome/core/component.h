@@ -0,0 +1,213 @@
+#pragma once
+// Host core: the parts of the ESPHome component model the components rely on, a scheduler of named
+// timeouts and intervals and a main loop that skips disabled loop() calls, on the simulated clock
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+namespace setup_priority {
+inline const float DATA = 600.0f;
+inline const float AFTER_WIFI = 200.0f;
+inline const float LATE = -100.0f;
+}  // namespace setup_priority
+
+class Component;
+
+namespace host {
+
+#define HOST_LOOP_INTERVAL_MS 16   // ESPHome's default main loop interval
+
+// What the components cost the main loop
+struct Stats
+{
+    uint64_t ticks;        // main loop iterations
+    uint64_t loops;        // loop() calls
+    uint64_t callbacks;    // timeouts and intervals that fired
+    uint64_t cpu_ns;       // wall time spent in loop() and the callbacks
+};
+
+struct Timer
+{
+    Component *component;
+    std::string name;
+    bool interval;
+    uint32_t period;
+    uint64_t due_us;
+    std::function<void()> callback;
+    bool removed;
+};
+
+class Core
+{
+  public:
+    void add(Component *component);
+    void add_timer(Component *component, const std::string &name, bool interval, uint32_t period, std::function<void()> &&callback)
+    {
+        this->cancel(component, name, interval);
+        this->timers_.push_back(Timer{component, name, interval, period, g_now_us + (uint64_t) period * 1000, std::move(callback), false});
+    }
+    bool cancel(Component *component, const std::string &name, bool interval)
+    {
+        bool found = false;
+        for (Timer &timer : this->timers_)
+        {
+            if (!timer.removed && timer.component == component && timer.interval == interval && timer.name == name)
+            {
+                timer.removed = true;
+                found = true;
+            }
+        }
+        return found;
+    }
+    // Run the main loop on the simulated clock for the given time
+    void run(uint32_t ms);
+    void reset_stats() { this->stats_ = {}; }
+    // Forget every component and timer, for the next scenario of a test
+    void clear()
+    {
+        this->components_.clear();
+        this->timers_.clear();
+        this->stats_ = {};
+        this->loop_always_ = false;
+    }
+    const Stats &stats() const { return this->stats_; }
+    // Emulates the components before loop sleeping: disable_loop() is ignored
+    void set_loop_always(bool always) { this->loop_always_ = always; }
+    bool is_loop_always() const { return this->loop_always_; }
+
+  protected:
+    void tick();
+
+    std::vector<Component *> components_;
+    std::vector<Timer> timers_;
+    Stats stats_{};
+    bool loop_always_{false};
+};
+
+inline Core g_core;
+
+}  // namespace host
+
+class Component
+{
+  public:
+    virtual ~Component() = default;
+    virtual void setup() {}
+    virtual void loop() {}
+    virtual void dump_config() {}
+    virtual void on_shutdown() {}
+    virtual float get_setup_priority() const { return 0.0f; }
+    virtual void call_setup() { this->setup(); }
+
+    void enable_loop() { this->loop_enabled_ = true; }
+    void disable_loop()
+    {
+        if (!host::g_core.is_loop_always())
+            this->loop_enabled_ = false;
+    }
+    bool is_loop_enabled() const { return this->loop_enabled_; }
+    void mark_failed() { this->failed_ = true; }
+    bool is_failed() const { return this->failed_; }
+
+  protected:
+    void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f)
+    {
+        host::g_core.add_timer(this, name, false, timeout, std::move(f));
+    }
+    bool cancel_timeout(const std::string &name) { return host::g_core.cancel(this, name, false); }
+    void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f)
+    {
+        host::g_core.add_timer(this, name, true, interval, std::move(f));
+    }
+    bool cancel_interval(const std::string &name) { return host::g_core.cancel(this, name, true); }
+    void status_set_warning() {}
+    void status_clear_warning() {}
+
+    bool loop_enabled_{true};
+    bool failed_{false};
+};
+
+class PollingComponent : public Component
+{
+  public:
+    PollingComponent() = default;
+    explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+    virtual void update() = 0;
+    void call_setup() override
+    {
+        this->setup();
+        this->set_interval("update", this->update_interval_, [this]() { this->update(); });
+    }
+    uint32_t get_update_interval() const { return this->update_interval_; }
+    void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+
+  protected:
+    uint32_t update_interval_{0};
+};
+
+namespace host {
+
+inline void Core::add(Component *component)
+{
+    this->components_.push_back(component);
+    component->call_setup();
+}
+
+inline void Core::tick()
+{
+    using clock = std::chrono::steady_clock;
+    this->stats_.ticks++;
+    // Timers first, like the ESPHome scheduler. Callbacks may add timers, so index, do not iterate.
+    for (size_t i = 0; i < this->timers_.size(); i++)
+    {
+        if (this->timers_[i].removed || this->timers_[i].due_us > g_now_us)
+            continue;
+        std::function<void()> callback = this->timers_[i].callback;
+        if (this->timers_[i].interval)
+            this->timers_[i].due_us += (uint64_t) this->timers_[i].period * 1000;
+        else
+            this->timers_[i].removed = true;
+        clock::time_point start = clock::now();
+        callback();
+        this->stats_.cpu_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        this->stats_.callbacks++;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < this->timers_.size(); i++)
+    {
+        if (this->timers_[i].removed)
+            continue;
+        if (kept != i)   // A self move would empty the name, the timer could not be replaced or cancelled any more
+            this->timers_[kept] = std::move(this->timers_[i]);
+        kept++;
+    }
+    this->timers_.resize(kept);
+    for (Component *component : this->components_)
+    {
+        if (!component->is_loop_enabled())
+            continue;
+        clock::time_point start = clock::now();
+        component->loop();
+        this->stats_.cpu_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        this->stats_.loops++;
+    }
+}
+
+inline void Core::run(uint32_t ms)
+{
+    uint64_t end_us = g_now_us + (uint64_t) ms * 1000;
+    while (g_now_us < end_us)
+    {
+        this->tick();
+        g_now_us += HOST_LOOP_INTERVAL_MS * 1000;
+    }
+}
+
+}  // namespace host
+}  // namespace esphome
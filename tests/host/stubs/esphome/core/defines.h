@@ -0,0 +1,2 @@
+#pragma once
+// The features are enabled per test with compile definitions
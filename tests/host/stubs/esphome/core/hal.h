@@ -0,0 +1,14 @@
+#pragma once
+// Simulated clock of the host core, it only moves when a test advances it
+#include <cstdint>
+
+namespace esphome {
+namespace host {
+inline uint64_t g_now_us = 0;
+}  // namespace host
+
+inline uint32_t millis() { return (uint32_t) (host::g_now_us / 1000); }
+inline uint32_t micros() { return (uint32_t) host::g_now_us; }
+inline void delay(uint32_t ms) { host::g_now_us += (uint64_t) ms * 1000; }
+
+}  // namespace esphome
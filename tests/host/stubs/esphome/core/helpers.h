@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+
+template<typename T> class Parented
+{
+  public:
+    Parented() = default;
+    void set_parent(T *parent) { this->parent_ = parent; }
+    T *get_parent() const { return this->parent_; }
+
+  protected:
+    T *parent_{nullptr};
+};
+
+inline uint32_t fnv1_hash(const std::string &str)
+{
+    uint32_t hash = 2166136261UL;
+    for (char c : str)
+    {
+        hash *= 16777619UL;
+        hash ^= (uint8_t) c;
+    }
+    return hash;
+}
+
+inline std::string format_hex_pretty(const uint8_t *data, size_t length)
+{
+    static const char *const digits = "0123456789ABCDEF";
+    std::string ret;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (i > 0)
+            ret += '.';
+        ret += digits[data[i] >> 4];
+        ret += digits[data[i] & 0x0F];
+    }
+    return ret;
+}
+
+template<typename... X> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)>
+{
+  public:
+    void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+    void call(Ts... args)
+    {
+        for (auto &callback : this->callbacks_)
+            callback(args...);
+    }
+    size_t size() const { return this->callbacks_.size(); }
+
+  protected:
+    std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+// The host core drops the log output, the format arguments are still checked
+#include <cstdarg>
+
+namespace esphome {
+namespace host {
+__attribute__((format(printf, 1, 2))) inline void log(const char *format, ...) {}
+}  // namespace host
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define ESP_LOGW(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define ESP_LOGI(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define ESP_LOGD(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define ESP_LOGV(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define ESP_LOGCONFIG(tag, ...) ((void) (tag), esphome::host::log(__VA_ARGS__))
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
+#define LOG_BINARY_SENSOR(prefix, type, obj) (void) (obj)
+#define LOG_TEXT_SENSOR(prefix, type, obj) (void) (obj)
+#define LOG_SWITCH(prefix, type, obj) (void) (obj)
+#define LOG_SELECT(prefix, type, obj) (void) (obj)
+#define LOG_BUTTON(prefix, type, obj) (void) (obj)
+#define LOG_UPDATE_INTERVAL(obj) (void) (obj)
+#define YESNO(b) ((b) ? "YES" : "NO")
@@ -0,0 +1,64 @@
+#pragma once
+// Host stand-in for the ESPHome preference store, every preference is a file in one directory,
+// so a test "reboots" by setting up its objects again on the same directory
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+namespace esphome {
+
+class ESPPreferenceObject
+{
+  public:
+    ESPPreferenceObject() = default;
+    ESPPreferenceObject(std::string path, uint32_t *writes) : path_(std::move(path)), writes_(writes) {}
+
+    template<typename T> bool save(const T *src)
+    {
+        FILE *file = fopen(this->path_.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+        bool ok = fwrite(src, sizeof(T), 1, file) == 1;
+        fclose(file);
+        if (ok)
+            (*this->writes_)++;
+        return ok;
+    }
+
+    // Like the flash backends, a stored value of another size does not load
+    template<typename T> bool load(T *dest)
+    {
+        FILE *file = fopen(this->path_.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+        bool ok = fread(dest, sizeof(T), 1, file) == 1 && fgetc(file) == EOF;
+        fclose(file);
+        return ok;
+    }
+
+  protected:
+    std::string path_;
+    uint32_t *writes_{nullptr};
+};
+
+class ESPPreferences
+{
+  public:
+    explicit ESPPreferences(std::string dir) : dir_(std::move(dir)) {}
+
+    template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash)
+    {
+        return ESPPreferenceObject(this->dir_ + "/" + std::to_string(type), &this->writes_);
+    }
+
+    uint32_t get_writes() const { return this->writes_; }
+
+  protected:
+    std::string dir_;
+    uint32_t writes_{0};
+};
+
+inline ESPPreferences *global_preferences = nullptr;
+
+}  // namespace esphome
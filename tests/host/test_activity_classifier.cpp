@@ -0,0 +1,252 @@
+// Activity classifier: synthetic traces of every class through the default model, the confirm_count
+// debounce, set_empty() on an unmanned report, and the activity sensor once the stream stops
+#include "harness.h"
+#include "host_radar.h"
+
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::host;
+using namespace esphome::mr24hpc1;
+
+// ACTIVITY_DEFAULT_MODEL of text_sensor.py in Q8, features in ACTIVITY_FEATURE_* order
+static const int32_t DEFAULT_BIAS[ACTIVITY_MAX] = {15360, 7680, 0, -10240, -17920};
+static const int16_t DEFAULT_WEIGHTS[ACTIVITY_MAX][ACTIVITY_FEATURE_MAX] = {
+    {-256, -256, -512, 0, 0, 0},           // empty
+    {128, -256, 0, -1280, -128, -1280},    // still
+    {51, 77, 256, -2560, 0, -1280},        // light movement
+    {0, 128, 128, 6400, 0, -1280},         // walking
+    {51, 102, 128, 0, 128, 6400},          // several people
+};
+
+// Exposes the per frame class, before the confirm_count debounce
+class TestClassifier : public ActivityClassifier
+{
+  public:
+    TestClassifier(uint8_t window_size, uint8_t confirm_count)
+    {
+        this->set_window_size(window_size);
+        this->set_confirm_count(confirm_count);
+        for (uint8_t activity = 0; activity < ACTIVITY_MAX; activity++)
+            this->set_class(activity, DEFAULT_BIAS[activity], DEFAULT_WEIGHTS[activity]);
+    }
+    using ActivityClassifier::classify;
+};
+
+// Synthetic underlying open reports of each class, one per second, with a little noise
+class Trace
+{
+  public:
+    explicit Trace(uint8_t activity, uint32_t seed = 1) : activity_(activity), seed_(seed) {}
+
+    UnderlyingOpenFrame next()
+    {
+        UnderlyingOpenFrame frame{};
+        switch (this->activity_)
+        {
+            case ACTIVITY_EMPTY:   // Background energy only
+                frame = {(uint8_t) (4 + this->noise(3)), 0, (uint8_t) (2 + this->noise(3)), 0, 10, (uint8_t) this->noise(2)};
+                break;
+            case ACTIVITY_STILL:   // Seated: strong static energy, breathing only
+                frame = {(uint8_t) (58 + this->noise(5)), 4, (uint8_t) (6 + this->noise(5)), 4, 10, (uint8_t) (1 + this->noise(3))};
+                break;
+            case ACTIVITY_LIGHT_MOVEMENT:   // Working at a desk: movement in place
+                frame = {(uint8_t) (38 + this->noise(5)), 4, (uint8_t) (36 + this->noise(9)), 4, 10,
+                         (uint8_t) (26 + this->noise(9))};
+                break;
+            case ACTIVITY_WALKING:   // Up and down the room at 1 m/s, 2 distance steps per report
+                if (this->distance_ == 2 || this->distance_ == 12)
+                    this->step_ = -this->step_;
+                this->distance_ += this->step_;
+                frame = {(uint8_t) (15 + this->noise(5)), this->distance_, (uint8_t) (66 + this->noise(9)), this->distance_, 8,
+                         (uint8_t) (46 + this->noise(9))};
+                break;
+            default:   // Two targets, the motion distance jumps between them
+                this->distance_ = this->distance_ == 2 ? 7 : 2;
+                frame = {(uint8_t) (45 + this->noise(9)), 2, (uint8_t) (this->distance_ == 2 ? 30 : 95), this->distance_,
+                         (uint8_t) (10 + this->noise(2)), (uint8_t) (38 + this->noise(9))};
+                break;
+        }
+        return frame;
+    }
+
+  protected:
+    uint32_t noise(uint32_t range)
+    {
+        this->seed_ = this->seed_ * 1103515245 + 12345;
+        return (this->seed_ >> 16) % range;
+    }
+
+    uint8_t activity_;
+    uint32_t seed_;
+    uint8_t distance_{2};
+    int8_t step_{-2};
+};
+
+// Every trace, one after the other: the window mixes two traces for a few reports, after window +
+// confirm_count reports the activity of the trace is settled and no further transition is published
+static void test_traces()
+{
+    TestClassifier classifier(10, 3);
+    const uint8_t sequence[] = {ACTIVITY_STILL,  ACTIVITY_WALKING,        ACTIVITY_SEVERAL_PEOPLE, ACTIVITY_LIGHT_MOVEMENT,
+                                ACTIVITY_STILL,  ACTIVITY_LIGHT_MOVEMENT, ACTIVITY_WALKING,        ACTIVITY_EMPTY,
+                                ACTIVITY_SEVERAL_PEOPLE};
+    for (uint8_t activity : sequence)
+    {
+        Trace trace(activity, activity + 1);
+        uint32_t changes = 0;
+        for (uint32_t i = 0; i < 60; i++)
+        {
+            bool changed = classifier.feed(trace.next());
+            changes += changed;
+            if (i == 10 + 3 - 1)
+                CHECK_EQ(classifier.get_activity(), activity);
+            if (i >= 10 + 3)
+                CHECK(!changed);
+        }
+        CHECK(changes >= 1 && changes <= 2);
+        CHECK_EQ(classifier.get_activity(), activity);
+    }
+}
+
+// Counts how often in a row the same class won, like the debounce does
+struct Wins
+{
+    uint8_t activity{ACTIVITY_UNKNOWN};
+    uint8_t count{0};
+
+    void add(uint8_t activity)
+    {
+        this->count = activity == this->activity ? this->count + 1 : 1;
+        this->activity = activity;
+    }
+};
+
+// A new class has to win confirm_count reports in a row, an interruption starts the count over
+static void test_confirm_count()
+{
+    for (uint8_t confirm_count : {1, 3, 5})
+    {
+        TestClassifier classifier(2, confirm_count);
+        Trace still(ACTIVITY_STILL);
+        Trace walking(ACTIVITY_WALKING);
+        for (uint8_t i = 0; i < 10; i++)
+            classifier.feed(still.next());
+        CHECK_EQ(classifier.get_activity(), ACTIVITY_STILL);
+
+        // Another class wins confirm_count - 1 reports, then still wins again
+        Wins wins;
+        while (wins.activity == ACTIVITY_STILL || wins.count + 1 < confirm_count)
+        {
+            CHECK(!classifier.feed(walking.next()));
+            wins.add(classifier.classify());
+        }
+        while (classifier.classify() != ACTIVITY_STILL)
+            CHECK(!classifier.feed(still.next()));
+        CHECK_EQ(classifier.get_activity(), ACTIVITY_STILL);
+
+        // confirm_count wins in a row, the last one publishes
+        wins = Wins{};
+        bool changed = false;
+        while (!changed)
+        {
+            changed = classifier.feed(walking.next());
+            wins.add(classifier.classify());
+        }
+        CHECK(wins.activity != ACTIVITY_STILL);
+        CHECK_EQ(wins.count, confirm_count);
+        CHECK_EQ(classifier.get_activity(), wins.activity);
+    }
+}
+
+// The radar reports the room unmanned: empty right away, then a fresh window
+static void test_set_empty()
+{
+    TestClassifier classifier(10, 3);
+    Trace walking(ACTIVITY_WALKING);
+    for (uint8_t i = 0; i < 20; i++)
+        classifier.feed(walking.next());
+    CHECK_EQ(classifier.get_activity(), ACTIVITY_WALKING);
+
+    CHECK(classifier.set_empty());
+    CHECK_EQ(classifier.get_activity(), ACTIVITY_EMPTY);
+    CHECK(!classifier.set_empty());   // Already empty, nothing to publish
+
+    // No old samples are left: the window fills up again before walking can be confirmed
+    uint8_t reports = 0;
+    while (!classifier.feed(walking.next()))
+        reports++;
+    CHECK_EQ(reports, 10 - 1 + 3 - 1);
+    CHECK_EQ(classifier.get_activity(), ACTIVITY_WALKING);
+
+    // reset() forgets the activity, the next confirmed one is a change even when it is the same
+    CHECK(classifier.reset());
+    CHECK_EQ(classifier.get_activity(), ACTIVITY_UNKNOWN);
+    CHECK(!classifier.reset());
+    reports = 0;
+    while (!classifier.feed(walking.next()))
+        reports++;
+    CHECK_EQ(reports, 10 - 1 + 3 - 1);
+    CHECK_EQ(classifier.get_activity(), ACTIVITY_WALKING);
+}
+
+static void report(Instance &instance, const UnderlyingOpenFrame &frame)
+{
+    instance.simulated.send(0x08, 0x07, frame.movement_signs);
+    instance.simulated.report_underlying(frame.static_energy, frame.presence_distance, frame.motion_energy,
+                                         frame.motion_distance, frame.motion_speed);
+    g_core.run(1000);
+}
+
+// The activity sensor of the component: published on transitions only, cleared once the stream stops
+static void test_component()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    instance.radar.set_activity_text_sensor(&instance.entities.activity);
+    instance.radar.set_activity_window(10, 3);
+    for (uint8_t activity = 0; activity < ACTIVITY_MAX; activity++)
+    {
+        const int16_t *weights = DEFAULT_WEIGHTS[activity];
+        instance.radar.set_activity_class(activity, DEFAULT_BIAS[activity], weights[0], weights[1], weights[2], weights[3],
+                                          weights[4], weights[5]);
+    }
+    scenario.start();
+    instance.simulated.send(0x08, 0x00, 0x01);   // Stream on
+    instance.simulated.report_presence(true);
+    g_core.run(100);
+
+    text_sensor::TextSensor &activity = instance.entities.activity;
+    Trace walking(ACTIVITY_WALKING);
+    for (uint8_t i = 0; i < 20; i++)
+        report(instance, walking.next());
+    CHECK(activity.state == "Walking");
+    uint32_t publishes = activity.publishes;
+    for (uint8_t i = 0; i < 20; i++)
+        report(instance, walking.next());
+    CHECK_EQ(activity.publishes, publishes);
+
+    // Stream off: no stale "Walking" while nothing classifies any more
+    instance.simulated.send(0x08, 0x00, 0x00);
+    g_core.run(100);
+    CHECK(activity.state.empty());
+
+    // Back on, the same activity is published again
+    instance.simulated.send(0x08, 0x00, 0x01);
+    for (uint8_t i = 0; i < 20; i++)
+        report(instance, walking.next());
+    CHECK(activity.state == "Walking");
+
+    instance.simulated.report_presence(false);
+    g_core.run(100);
+    CHECK(activity.state == "Empty");
+}
+
+int main()
+{
+    test_traces();
+    test_confirm_count();
+    test_set_empty();
+    test_component();
+    return test_result("test_activity_classifier");
+}
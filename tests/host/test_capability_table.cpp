@@ -0,0 +1,83 @@
+// Firmware capability probing: verdicts from answered and unanswered queries, re-probing the unsupported
+// ones without losing the verdict meanwhile, and active reports standing in for a query
+#include "harness.h"
+#include "mr24hpc1/capability_table.h"
+
+using namespace esphome::mr24hpc1;
+
+static void send_unanswered(CapabilityTable &table, uint8_t control, uint8_t command, uint8_t times)
+{
+    for (uint8_t i = 0; i < times; i++)
+        table.sent(control, command);
+}
+
+static void test_verdicts()
+{
+    CapabilityTable table;
+    CHECK(table.is_supported(CAPABILITY_KEEP_AWAY));   // Unknown commands are sent
+    send_unanswered(table, 0x80, 0x8B, CAPABILITY_PROBE_ATTEMPTS - 1);
+    CHECK(!table.is_unsupported(CAPABILITY_KEEP_AWAY));
+    CHECK(table.sent(0x80, 0x8B));
+    CHECK(table.is_unsupported(CAPABILITY_KEEP_AWAY));
+    CHECK(!table.is_supported(CAPABILITY_KEEP_AWAY));
+    CHECK(!table.sent(0x80, 0x8B));   // Decided, not counted any more
+
+    CHECK(table.answered(0x80, 0x81));
+    CHECK(!table.answered(0x80, 0x81));   // Already known
+    CHECK(table.is_supported(CAPABILITY_HUMAN_STATUS));
+    CHECK(!table.answered(0x01, 0x01));   // Not in the table
+    CHECK_EQ(table.bitmap().probed, (1u << CAPABILITY_KEEP_AWAY) | (1u << CAPABILITY_HUMAN_STATUS));
+    CHECK_EQ(table.bitmap().supported, 1u << CAPABILITY_HUMAN_STATUS);
+}
+
+// The query went unanswered but the radar reports the same information by itself
+static void test_active_report()
+{
+    CapabilityTable table;
+    send_unanswered(table, 0x80, 0x8B, CAPABILITY_PROBE_ATTEMPTS);
+    CHECK(table.is_unsupported(CAPABILITY_KEEP_AWAY));
+    CHECK(table.answered(0x80, 0x0B));
+    CHECK(!table.is_unsupported(CAPABILITY_KEEP_AWAY));
+    CHECK(table.is_supported(CAPABILITY_KEEP_AWAY));
+}
+
+static void test_reprobe()
+{
+    CapabilityTable table;
+    send_unanswered(table, 0x80, 0x8B, CAPABILITY_PROBE_ATTEMPTS);
+    send_unanswered(table, 0x05, 0x87, CAPABILITY_PROBE_ATTEMPTS);
+    table.answered(0x80, 0x81);
+    CapabilityBitmap persisted = table.bitmap();
+
+    CHECK_EQ(table.reprobe(), (1u << CAPABILITY_KEEP_AWAY) | (1u << CAPABILITY_SCENE_MODE));
+    CHECK(table.is_supported(CAPABILITY_KEEP_AWAY));     // Sent again
+    CHECK(table.is_unsupported(CAPABILITY_KEEP_AWAY));   // The entities keep the verdict meanwhile
+    CHECK(table.is_reprobing(0x80, 0x8B));
+    CHECK(!table.is_reprobing(0x80, 0x81));
+
+    // Still unanswered: the same verdict, the persisted bitmap is unchanged
+    send_unanswered(table, 0x80, 0x8B, CAPABILITY_PROBE_ATTEMPTS - 1);
+    CHECK(table.sent(0x80, 0x8B));
+    CHECK(!table.is_reprobing(0x80, 0x8B));
+    CHECK(!table.is_supported(CAPABILITY_KEEP_AWAY));
+    CHECK_EQ(table.bitmap().probed, persisted.probed);
+    CHECK_EQ(table.bitmap().supported, persisted.supported);
+
+    // Answered this time: revised to supported
+    CHECK(table.answered(0x05, 0x87));
+    CHECK(!table.is_reprobing(0x05, 0x87));
+    CHECK(!table.is_unsupported(CAPABILITY_SCENE_MODE));
+    CHECK_EQ(table.bitmap().supported, persisted.supported | (1u << CAPABILITY_SCENE_MODE));
+
+    CHECK_EQ(table.reprobe(), 1u << CAPABILITY_KEEP_AWAY);
+    table.reset();
+    CHECK(!table.is_reprobing(0x80, 0x8B));
+}
+
+int main()
+{
+    test_verdicts();
+    test_active_report();
+    test_reprobe();
+    return test_result("test_capability_table");
+}
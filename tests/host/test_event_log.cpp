@@ -0,0 +1,119 @@
+// Event log: the flash page ring on a file-backed preference store, across simulated reboots
+#include "harness.h"
+#include "mr24hpc1/event_log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::mr24hpc1;
+
+#define BASE_HASH 0x4D520000
+
+static std::vector<EventRecord> read_all(EventLog &log)
+{
+    std::vector<EventRecord> records;
+    log.read([&records](const EventRecord &record) { records.push_back(record); });
+    return records;
+}
+
+// Record n of a test sequence, timestamps count up so the order can be checked
+static void append(EventLog &log, uint32_t n) { log.append(1000 + n, EVENT_PRESENCE + n % 3, n & 0xFF); }
+
+static bool is_record(const EventRecord &record, uint32_t n)
+{
+    return record.timestamp == 1000 + n && record.type == EVENT_PRESENCE + n % 3 && record.value == (n & 0xFF);
+}
+
+static void boot(EventLog &log, uint8_t pages)
+{
+    log = EventLog();
+    log.set_pages(pages);
+    log.setup(BASE_HASH);
+}
+
+static void test_flush_and_reboot()
+{
+    EventLog log;
+    boot(log, 4);
+    CHECK(read_all(log).empty());
+
+    // A full page is written as soon as it fills up, the rest stays in RAM
+    for (uint32_t n = 0; n < EVENT_LOG_PAGE_RECORDS + 4; n++)
+        append(log, n);
+    CHECK_EQ(global_preferences->get_writes(), 1);
+    CHECK_EQ(log.get_buffered(), 4);
+    std::vector<EventRecord> records = read_all(log);
+    CHECK_EQ(records.size(), EVENT_LOG_PAGE_RECORDS + 4);
+    for (uint32_t n = 0; n < records.size(); n++)
+        CHECK(is_record(records[n], n));
+
+    // Records still in RAM are lost by a reboot, flushed ones survive it
+    boot(log, 4);
+    CHECK_EQ(read_all(log).size(), EVENT_LOG_PAGE_RECORDS);
+    for (uint32_t n = EVENT_LOG_PAGE_RECORDS; n < EVENT_LOG_PAGE_RECORDS + 4; n++)
+        append(log, n);
+    log.flush();
+    log.flush();   // Nothing buffered, no write
+    CHECK_EQ(global_preferences->get_writes(), 2);
+
+    boot(log, 4);
+    records = read_all(log);
+    CHECK_EQ(records.size(), EVENT_LOG_PAGE_RECORDS + 4);
+    for (uint32_t n = 0; n < records.size(); n++)
+        CHECK(is_record(records[n], n));
+}
+
+static void test_ring_wrap()
+{
+    // Continues from the pages of test_flush_and_reboot: 2 pages, the second one partly filled
+    EventLog log;
+    boot(log, 4);
+    uint32_t n = EVENT_LOG_PAGE_RECORDS + 4;
+    for (uint8_t page = 0; page < 5; page++)
+    {
+        for (uint8_t i = 0; i < EVENT_LOG_PAGE_RECORDS; i++)
+            append(log, n++);
+        boot(log, 4);   // Every page survives its own reboot
+    }
+
+    // Only the newest 4 pages are kept, the oldest ones were overwritten in place
+    std::vector<EventRecord> records = read_all(log);
+    CHECK_EQ(records.size(), 4 * EVENT_LOG_PAGE_RECORDS);
+    uint32_t first = n - 4 * EVENT_LOG_PAGE_RECORDS;
+    for (uint32_t i = 0; i < records.size(); i++)
+        CHECK(is_record(records[i], first + i));
+
+    // A page of another store, or of an older layout, does not load
+    ESPPreferenceObject slot = global_preferences->make_preference<uint32_t>(BASE_HASH + 1, true);
+    uint32_t garbage = 0xDEADBEEF;
+    slot.save(&garbage);
+    boot(log, 4);
+    CHECK_EQ(read_all(log).size(), 3 * EVENT_LOG_PAGE_RECORDS);
+}
+
+static void test_event_names()
+{
+    CHECK(strcmp(event_type_to_str(EVENT_PRESENCE), "presence") == 0);
+    CHECK(strcmp(event_type_to_str(EVENT_KEEP_AWAY | EVENT_FLAG_UPTIME), "keep away") == 0);
+    CHECK(strcmp(event_type_to_str(0), "unknown") == 0);
+    CHECK(strcmp(event_type_to_str(9), "unknown") == 0);
+}
+
+int main()
+{
+    char dir[] = "/tmp/event_log_XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+        return 1;
+    ESPPreferences store(dir);
+    global_preferences = &store;
+
+    test_flush_and_reboot();
+    test_ring_wrap();
+    test_event_names();
+
+    std::string cleanup = std::string("rm -rf ") + dir;
+    (void) !system(cleanup.c_str());
+    return test_result("test_event_log");
+}
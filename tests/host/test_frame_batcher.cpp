@@ -0,0 +1,131 @@
+// Collector stream packets: the header and record encoding, and when a batch of ring frames is due
+#include "harness.h"
+#include "mr24hpc1/frame_batcher.h"
+
+#include <initializer_list>
+
+using namespace esphome::mr24hpc1;
+
+static uint32_t get_uint32(const uint8_t *in) { return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t) in[3] << 24); }
+
+static UnderlyingOpenFrame make_frame(uint32_t i)
+{
+    UnderlyingOpenFrame frame{};
+    frame.static_energy = i & 0xFF;
+    frame.presence_distance = 3;
+    frame.motion_energy = (i * 3) & 0xFF;
+    frame.motion_distance = 4;
+    frame.motion_speed = 12;
+    frame.movement_signs = 50;
+    return frame;
+}
+
+static void test_encoding()
+{
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameBatcher batcher;
+    batcher.set_batch(16, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+
+    for (uint32_t i = 0; i < 5; i++)
+        ring.push(make_frame(i), 100 + i * 50);
+    CHECK(batcher.has_pending(ring));
+    CHECK(!batcher.is_due(ring, 500));   // Less than a batch and the flush interval has not expired
+    CHECK(batcher.is_due(ring, 1000));
+
+    size_t len = batcher.encode(ring, packet);
+    CHECK_EQ(len, STREAM_HEADER_SIZE + 5 * STREAM_RECORD_SIZE);
+    CHECK_EQ(packet[0], 'M');
+    CHECK_EQ(packet[1], 'R');
+    CHECK_EQ(packet[2], STREAM_PACKET_VERSION);
+    CHECK_EQ(packet[3], 5);
+    CHECK_EQ(get_uint32(&packet[4]), 0);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        const uint8_t *record = &packet[STREAM_HEADER_SIZE + i * STREAM_RECORD_SIZE];
+        CHECK_EQ(get_uint32(&record[0]), i);
+        CHECK_EQ(get_uint32(&record[4]), 100 + i * 50);
+        CHECK_EQ(record[8], i);
+        CHECK_EQ(record[9], 3);
+        CHECK_EQ(record[10], i * 3);
+        CHECK_EQ(record[11], 4);
+        CHECK_EQ(record[12], 12);
+        CHECK_EQ(record[13], 50);
+        CHECK_EQ(record[14], 0);
+        CHECK_EQ(record[15], 0);
+    }
+
+    // Not committed: the send failed, the same frames go out again
+    CHECK(batcher.is_due(ring, 1100));
+    CHECK_EQ(batcher.encode(ring, packet), len);
+    CHECK_EQ(get_uint32(&packet[STREAM_HEADER_SIZE]), 0);
+    batcher.commit(1100);
+    CHECK(!batcher.has_pending(ring));
+    CHECK(!batcher.is_due(ring, 5000));
+}
+
+static void test_batching()
+{
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameBatcher batcher;
+    batcher.set_batch(16, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+    batcher.commit(0);
+
+    for (uint32_t i = 0; i < 40; i++)
+        ring.push(make_frame(i), 10 + i);
+    uint32_t now = 60;
+    uint32_t expected_seq = 0;
+    for (uint8_t expected_count : {16, 16})
+    {
+        CHECK(batcher.is_due(ring, now));   // Full batches go out right away
+        batcher.encode(ring, packet);
+        CHECK_EQ(packet[3], expected_count);
+        CHECK_EQ(get_uint32(&packet[STREAM_HEADER_SIZE]), expected_seq);
+        batcher.commit(now);
+        expected_seq += expected_count;
+    }
+    CHECK(!batcher.is_due(ring, now + 999));   // 8 left, they wait for the flush interval
+    CHECK_EQ(batcher.flush_delay(now + 400), 600);
+    CHECK(batcher.is_due(ring, now + 1000));
+    CHECK_EQ(batcher.flush_delay(now + 1500), 1000);   // Overdue, a failed send is tried again one interval later
+    batcher.encode(ring, packet);
+    CHECK_EQ(packet[3], 8);
+    batcher.commit(now + 1000);
+    CHECK(!batcher.has_pending(ring));
+}
+
+// A collector that is unreachable for a while loses the oldest frames, the header counts them
+static void test_drop_oldest()
+{
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameBatcher batcher;
+    batcher.set_batch(32, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+
+    for (uint32_t i = 0; i < 100; i++)
+        ring.push(make_frame(i), i);
+    CHECK(batcher.is_due(ring, 100));
+    CHECK_EQ(batcher.get_dropped(), 100 - FRAME_RING_SIZE);
+    batcher.encode(ring, packet);
+    CHECK_EQ(packet[3], 32);
+    CHECK_EQ(get_uint32(&packet[4]), 100 - FRAME_RING_SIZE);
+    CHECK_EQ(get_uint32(&packet[STREAM_HEADER_SIZE]), 100 - FRAME_RING_SIZE);
+    batcher.commit(100);
+
+    // Overwritten again before the next send
+    for (uint32_t i = 100; i < 150; i++)
+        ring.push(make_frame(i), i);
+    CHECK(batcher.is_due(ring, 150));
+    CHECK_EQ(batcher.get_dropped(), 100 - FRAME_RING_SIZE + 18);
+    batcher.encode(ring, packet);
+    CHECK_EQ(get_uint32(&packet[STREAM_HEADER_SIZE]), 150 - FRAME_RING_SIZE);
+}
+
+int main()
+{
+    test_encoding();
+    test_batching();
+    test_drop_oldest();
+    return test_result("test_frame_batcher");
+}
@@ -0,0 +1,101 @@
+// Frame ring: seqlock snapshots taken by another task while the main loop keeps pushing are never torn
+#include "harness.h"
+#include "mr24hpc1/frame_ring.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace esphome::mr24hpc1;
+
+// Every field derives from the sequence number, a torn record does not match it
+static UnderlyingOpenFrame make_frame(uint32_t seq)
+{
+    UnderlyingOpenFrame frame{};
+    frame.static_energy = seq & 0xFF;
+    frame.presence_distance = (seq >> 8) & 0xFF;
+    frame.motion_energy = (seq * 7) & 0xFF;
+    frame.motion_distance = (seq >> 16) & 0xFF;
+    frame.motion_speed = (seq * 13) & 0xFF;
+    frame.movement_signs = (seq >> 24) & 0xFF;
+    return frame;
+}
+
+static bool is_intact(const FrameRecord &record)
+{
+    UnderlyingOpenFrame expected = make_frame(record.seq);
+    return record.timestamp_ms == record.seq * 3 && record.frame.static_energy == expected.static_energy &&
+           record.frame.presence_distance == expected.presence_distance &&
+           record.frame.motion_energy == expected.motion_energy &&
+           record.frame.motion_distance == expected.motion_distance &&
+           record.frame.motion_speed == expected.motion_speed && record.frame.movement_signs == expected.movement_signs;
+}
+
+static void test_snapshot()
+{
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameRecord out[FRAME_RING_SIZE];
+    size_t count = 99;
+    uint32_t next = 99;
+    CHECK(ring.try_snapshot(0, out, &count, &next));
+    CHECK_EQ(count, 0);
+    CHECK_EQ(next, 0);
+
+    for (uint32_t seq = 0; seq < 10; seq++)
+        ring.push(make_frame(seq), seq * 3);
+    CHECK(ring.try_snapshot(4, out, &count, &next));
+    CHECK_EQ(count, 6);
+    CHECK_EQ(next, 10);
+    CHECK_EQ(out[0].seq, 4);
+    CHECK(is_intact(out[5]));
+    CHECK(ring.try_snapshot(20, out, &count, &next));   // Past the end: nothing, the reader restarts at next
+    CHECK_EQ(count, 0);
+
+    for (uint32_t seq = 10; seq < 200; seq++)
+        ring.push(make_frame(seq), seq * 3);
+    CHECK(ring.try_snapshot(0, out, &count, &next));   // Overwritten frames are skipped
+    CHECK_EQ(count, FRAME_RING_SIZE);
+    CHECK_EQ(out[0].seq, 200 - FRAME_RING_SIZE);
+}
+
+// A reader thread never gets a torn or out of order snapshot while a writer thread pushes
+static void test_concurrent()
+{
+    static FrameRing<FRAME_RING_SIZE> ring;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (uint32_t seq = 0; seq < 2000000; seq++)
+            ring.push(make_frame(seq), seq * 3);
+        done = true;
+    });
+
+    FrameRecord out[FRAME_RING_SIZE];
+    uint32_t snapshots = 0, torn = 0;
+    uint32_t cursor = 0;
+    while (!done)
+    {
+        size_t count;
+        uint32_t next;
+        if (!ring.try_snapshot(cursor, out, &count, &next))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        snapshots++;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!is_intact(out[i]) || out[i].seq != next - count + i)
+                torn++;
+        }
+        cursor = next;
+    }
+    writer.join();
+    CHECK(snapshots > 0);
+    CHECK_EQ(torn, 0);
+}
+
+int main()
+{
+    test_snapshot();
+    test_concurrent();
+    return test_result("test_frame_ring");
+}
@@ -0,0 +1,203 @@
+// Collector stream over real sockets: UDP and TCP packets to a listener on 127.0.0.1, the reconnect
+// spacing after a refused connection and the new connection after a partial TCP write
+#include "harness.h"
+#include "mr24hpc1/frame_stream.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace esphome::mr24hpc1;
+
+static uint32_t get_uint32(const uint8_t *in) { return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t) in[3] << 24); }
+
+// The collector end, a non-blocking socket on an ephemeral port
+class Listener
+{
+  public:
+    explicit Listener(int type, uint16_t port = 0) : type_(type)
+    {
+        this->fd_ = socket(AF_INET, type | SOCK_NONBLOCK, 0);
+        int reuse = 1;
+        setsockopt(this->fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(this->fd_, (struct sockaddr *) &addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(this->fd_, (struct sockaddr *) &addr, &len);
+        this->port_ = ntohs(addr.sin_port);
+        if (type == SOCK_STREAM)
+            listen(this->fd_, 4);
+    }
+    ~Listener()
+    {
+        if (this->client_ >= 0)
+            close(this->client_);
+        close(this->fd_);
+    }
+
+    uint16_t port() const { return this->port_; }
+
+    bool accept_client()
+    {
+        if (this->client_ >= 0)
+            close(this->client_);
+        this->client_ = accept4(this->fd_, nullptr, nullptr, SOCK_NONBLOCK);
+        return this->client_ >= 0;
+    }
+
+    // Whatever arrives within the timeout, 0 on a closed connection, -1 when nothing came
+    ssize_t receive(uint8_t *buf, size_t len, int timeout_ms = 500)
+    {
+        int fd = this->type_ == SOCK_STREAM ? this->client_ : this->fd_;
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return -1;
+        return recv(fd, buf, len, 0);
+    }
+
+  protected:
+    int type_;
+    int fd_;
+    int client_{-1};
+    uint16_t port_;
+};
+
+static void push_frames(FrameRing<FRAME_RING_SIZE> &ring, uint32_t count, uint32_t now)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        UnderlyingOpenFrame frame{};
+        frame.static_energy = ring.next_seq() & 0xFF;
+        ring.push(frame, now);
+    }
+}
+
+static void check_packet(const uint8_t *packet, ssize_t len, uint8_t count, uint32_t first_seq)
+{
+    CHECK_EQ(len, STREAM_HEADER_SIZE + count * STREAM_RECORD_SIZE);
+    CHECK_EQ(packet[0], 'M');
+    CHECK_EQ(packet[1], 'R');
+    CHECK_EQ(packet[3], count);
+    CHECK_EQ(get_uint32(&packet[STREAM_HEADER_SIZE]), first_seq);
+    CHECK_EQ(packet[STREAM_HEADER_SIZE + 8], first_seq & 0xFF);
+}
+
+// Keep calling process() like the flush timer does until the listener has a connection
+static bool connect_tcp(FrameStreamer &streamer, FrameRing<FRAME_RING_SIZE> &ring, Listener &listener, uint32_t now)
+{
+    for (uint8_t i = 0; i < 50; i++)
+    {
+        streamer.process(ring, now);
+        if (listener.accept_client())
+            return true;
+        usleep(2000);
+    }
+    return false;
+}
+
+static void test_udp()
+{
+    Listener listener(SOCK_DGRAM);
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameStreamer streamer;
+    streamer.set_target("127.0.0.1", listener.port(), false);
+    streamer.set_batch(4, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+
+    push_frames(ring, 3, 10);
+    streamer.process(ring, 20);   // Less than a batch
+    CHECK_EQ(listener.receive(packet, sizeof(packet), 50), -1);
+    push_frames(ring, 1, 30);
+    streamer.process(ring, 40);
+    check_packet(packet, listener.receive(packet, sizeof(packet)), 4, 0);
+    CHECK(!streamer.has_pending(ring));
+
+    push_frames(ring, 2, 50);
+    streamer.process(ring, 1040);   // Flush interval expired
+    check_packet(packet, listener.receive(packet, sizeof(packet)), 2, 4);
+}
+
+static void test_tcp()
+{
+    Listener listener(SOCK_STREAM);
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameStreamer streamer;
+    streamer.set_target("127.0.0.1", listener.port(), true);
+    streamer.set_batch(4, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+
+    push_frames(ring, 4, 10);
+    CHECK(connect_tcp(streamer, ring, listener, 20));
+    for (uint8_t i = 0; i < 50 && streamer.has_pending(ring); i++)
+    {
+        usleep(2000);
+        streamer.process(ring, 20);   // The first write may find the connection still in progress
+    }
+    check_packet(packet, listener.receive(packet, sizeof(packet)), 4, 0);
+
+    // A partial write would desync the stream: the connection is closed, the batch is kept
+    push_frames(ring, 4, 100);
+    esphome::socket::host_write_limit() = 8;
+    streamer.process(ring, 110);
+    esphome::socket::host_write_limit() = 0;
+    CHECK_EQ(listener.receive(packet, sizeof(packet)), 8);
+    CHECK_EQ(listener.receive(packet, sizeof(packet)), 0);   // Closed
+    CHECK(streamer.has_pending(ring));
+
+    streamer.process(ring, 110 + 1000);   // Reconnects only after STREAM_RECONNECT_MS
+    usleep(20000);
+    CHECK(!listener.accept_client());
+    CHECK(connect_tcp(streamer, ring, listener, 20 + STREAM_RECONNECT_MS));
+    for (uint8_t i = 0; i < 50 && streamer.has_pending(ring); i++)
+    {
+        usleep(2000);
+        streamer.process(ring, 20 + STREAM_RECONNECT_MS);
+    }
+    check_packet(packet, listener.receive(packet, sizeof(packet)), 4, 4);   // The whole batch again
+}
+
+// Nobody listens: the refused connection is retried once per STREAM_RECONNECT_MS, the frames wait in the ring
+static void test_refused()
+{
+    uint16_t port;
+    {
+        Listener closed(SOCK_STREAM);
+        port = closed.port();
+    }
+    FrameRing<FRAME_RING_SIZE> ring;
+    FrameStreamer streamer;
+    streamer.set_target("127.0.0.1", port, true);
+    streamer.set_batch(4, 1000);
+    uint8_t packet[STREAM_PACKET_MAX_SIZE];
+
+    push_frames(ring, 4, 10);
+    streamer.process(ring, 100);
+    usleep(20000);
+    streamer.process(ring, 100);   // Sees the refusal and closes
+    CHECK(streamer.has_pending(ring));
+
+    Listener listener(SOCK_STREAM, port);
+    streamer.process(ring, 100 + STREAM_RECONNECT_MS - 1);
+    usleep(20000);
+    CHECK(!listener.accept_client());
+    CHECK(connect_tcp(streamer, ring, listener, 100 + STREAM_RECONNECT_MS));
+    for (uint8_t i = 0; i < 50 && streamer.has_pending(ring); i++)
+    {
+        usleep(2000);
+        streamer.process(ring, 100 + STREAM_RECONNECT_MS);
+    }
+    check_packet(packet, listener.receive(packet, sizeof(packet)), 4, 0);
+}
+
+int main()
+{
+    test_udp();
+    test_tcp();
+    test_refused();
+    return test_result("test_frame_stream");
+}
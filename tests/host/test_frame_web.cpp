@@ -0,0 +1,164 @@
+// Live view of the stream on the web server: the routes, the frames backfill with its decimation and
+// dropped count, the immediate busy answer while a push is in progress, and the decimated event sources
+#include "harness.h"
+#include "esphome/core/hal.h"
+#include "mr24hpc1/frame_web.h"
+
+#include <map>
+#include <string>
+
+using namespace esphome::mr24hpc1;
+using esphome::web_server_base::WebServerBase;
+
+// Leaves the ring half way through a push, like the main loop when the web server task reads it
+class PushingRing : public FrameRing<FRAME_RING_SIZE>
+{
+  public:
+    void begin_push() { this->version_.fetch_add(1); }
+    void end_push() { this->version_.fetch_add(1); }
+};
+
+struct WebView
+{
+    PushingRing ring;
+    FrameWebHandler handler{&ring, "/mr24hpc1"};
+    WebServerBase base;
+
+    WebView() { this->handler.register_handlers(&this->base); }
+
+    // Frame i carries i as its static energy
+    void push(uint32_t count, uint32_t now, uint32_t spacing_ms)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            UnderlyingOpenFrame frame{};
+            frame.static_energy = this->ring.next_seq() & 0xFF;
+            frame.motion_speed = 10;
+            this->ring.push(frame, now + i * spacing_ms);
+            this->handler.publish(*this->ring.get(this->ring.next_seq() - 1));
+        }
+    }
+
+    AsyncWebServerRequest get(const std::string &url, const std::map<std::string, std::string> &params = {})
+    {
+        AsyncWebServerRequest request(HTTP_GET, url, params);
+        this->base.host_request(&request);
+        return request;
+    }
+
+    AsyncEventSource *events(uint8_t rate) const
+    {
+        for (AsyncWebHandler *handler : this->base.handlers)
+        {
+            auto *events = dynamic_cast<AsyncEventSource *>(handler);
+            if (events != nullptr && events->url() == "/mr24hpc1/events/" + std::to_string(rate))
+                return events;
+        }
+        return nullptr;
+    }
+};
+
+static std::string record_json(uint32_t seq, uint32_t timestamp_ms)
+{
+    return "[" + std::to_string(seq) + "," + std::to_string(timestamp_ms) + "," + std::to_string(seq & 0xFF) + ",0,0,0,10,0]";
+}
+
+static void test_routes()
+{
+    WebView view;
+    CHECK_EQ(view.base.handlers.size(), 1 + WEB_RATE_COUNT);
+    for (uint8_t rate : s_web_rates)
+        CHECK(view.events(rate) != nullptr);
+
+    AsyncWebServerRequest page(HTTP_GET, "/mr24hpc1");
+    AsyncWebServerRequest frames(HTTP_GET, "/mr24hpc1/frames");
+    AsyncWebServerRequest post(HTTP_POST, "/mr24hpc1");
+    AsyncWebServerRequest events(HTTP_GET, "/mr24hpc1/events/2");
+    AsyncWebServerRequest other(HTTP_GET, "/mr24hpc1x");
+    CHECK(view.handler.canHandle(&page));
+    CHECK(view.handler.canHandle(&frames));
+    CHECK(!view.handler.canHandle(&post));
+    CHECK(!view.handler.canHandle(&events));   // Served by its event source
+    CHECK(!view.handler.canHandle(&other));
+
+    AsyncWebServerRequest request = view.get("/mr24hpc1");
+    CHECK(request.responded);
+    CHECK(request.response.content_type == "text/html");
+    CHECK(request.response.body.find("const P='/mr24hpc1'") != std::string::npos);
+}
+
+static void test_frames()
+{
+    WebView view;
+    view.push(10, 1000, 100);
+
+    AsyncWebServerRequest request = view.get("/mr24hpc1/frames", {{"since", "0"}, {"rate", "2"}});
+    CHECK(request.response.content_type == "application/json");
+    CHECK(request.response.body == "{\"next\":10,\"dropped\":0,\"frames\":[" + record_json(0, 1000) + "," + record_json(5, 1500) + "]}");
+
+    request = view.get("/mr24hpc1/frames", {{"since", "8"}, {"rate", "20"}});
+    CHECK(request.response.body == "{\"next\":10,\"dropped\":0,\"frames\":[" + record_json(8, 1800) + "," + record_json(9, 1900) + "]}");
+
+    request = view.get("/mr24hpc1/frames", {{"since", "0"}, {"rate", "0"}});   // Out of range: the default rate
+    CHECK(request.response.body == "{\"next\":10,\"dropped\":0,\"frames\":[" + record_json(0, 1000) + "," + record_json(5, 1500) + "]}");
+
+    // A viewer that fell more than the ring behind is told how many frames it missed
+    view.push(FRAME_RING_SIZE + 6, 2000, 1000);
+    request = view.get("/mr24hpc1/frames", {{"since", "4"}, {"rate", "1"}});
+    CHECK(request.response.body.find("{\"next\":80,\"dropped\":12,\"frames\":[" + record_json(16, 2000 + 6 * 1000) + ",") == 0);
+
+    // The device restarted since the page loaded: begin with what is there now
+    request = view.get("/mr24hpc1/frames", {{"since", "1000"}});
+    CHECK(request.response.body == "{\"next\":80,\"dropped\":0,\"frames\":[]}");
+}
+
+// The web server task never waits for the main loop
+static void test_busy()
+{
+    WebView view;
+    view.push(4, 0, 100);
+    view.ring.begin_push();
+    uint32_t start = esphome::millis();
+    AsyncWebServerRequest request = view.get("/mr24hpc1/frames", {{"since", "0"}});
+    CHECK(request.responded);
+    CHECK_EQ(request.response.code, 503);
+    CHECK_EQ(esphome::millis(), start);   // Answered right away, no delay()
+    view.ring.end_push();
+    request = view.get("/mr24hpc1/frames", {{"since", "0"}});
+    CHECK_EQ(request.response.code, 200);
+}
+
+// Every rate sends at most one frame per 1/rate s, and only rates with viewers format and send
+static void test_events()
+{
+    WebView view;
+    view.events(1)->clients = 1;
+    view.events(5)->clients = 2;
+    view.push(20, 0, 100);
+
+    CHECK_EQ(view.events(1)->sent.size(), 2);
+    CHECK(view.events(1)->sent[0].message == record_json(0, 0));
+    CHECK(view.events(1)->sent[0].event == "frame");
+    CHECK_EQ(view.events(1)->sent[1].id, 10);
+    CHECK_EQ(view.events(5)->sent.size(), 10);
+    for (size_t i = 0; i < view.events(5)->sent.size(); i++)
+        CHECK(view.events(5)->sent[i].message == record_json(2 * i, 200 * i));
+    CHECK(view.events(2)->sent.empty());
+    CHECK(view.events(10)->sent.empty());
+    CHECK(view.events(20)->sent.empty());
+
+    // A viewer joining later gets the next frame due at its rate
+    view.events(20)->clients = 1;
+    view.push(2, 2000, 50);
+    CHECK_EQ(view.events(20)->sent.size(), 2);
+    CHECK_EQ(view.events(20)->sent[0].id, 20);
+}
+
+int main()
+{
+    test_routes();
+    test_frames();
+    test_busy();
+    test_events();
+    return test_result("test_frame_web");
+}
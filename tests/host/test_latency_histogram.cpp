@@ -0,0 +1,131 @@
+// Presence latency: timed frames through the frame engine into the stage histograms, and the
+// histogram window that restarts with every publish
+#include "harness.h"
+#include "mr24hpc1/latency_histogram.h"
+#include "seeed_radar/seeed_radar_protocol.h"
+
+using esphome::mr24hpc1::LatencyHistogram;
+namespace seeed_radar = esphome::seeed_radar;
+
+static const uint32_t BYTE_US = 87;   // One byte at 115200 baud 8N1
+
+// Timestamps the frame hooks like mr24hpc1Component does, against a simulated microsecond clock
+struct TimedDecoder : public seeed_radar::FrameEngine<TimedDecoder, 32>
+{
+    uint32_t now_us{0};
+    uint32_t publish_cost_us{40};
+    uint32_t frame_start_us{0};
+    uint32_t frame_complete_us{0};
+    uint32_t errors{0};
+    LatencyHistogram receive;
+    LatencyHistogram total;
+
+    void on_frame_start() { this->frame_start_us = this->now_us; }
+    void on_frame_received() { this->frame_complete_us = this->now_us; }
+    void on_frame_error(const char *reason, uint8_t value) { this->errors++; }
+    void on_frame(uint8_t *frame, size_t len)
+    {
+        this->receive.record(this->frame_complete_us - this->frame_start_us);
+        this->now_us += this->publish_cost_us;   // The entity publish
+        this->total.record(this->now_us - this->frame_start_us);
+    }
+
+    void feed_timed(const uint8_t *bytes, size_t len, uint32_t stall_after = 0, uint32_t stall_us = 0)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            if (stall_after != 0 && i == stall_after)
+                this->now_us += stall_us;
+            this->feed(bytes[i]);
+            this->now_us += BYTE_US;
+        }
+    }
+};
+
+static void test_buckets()
+{
+    LatencyHistogram histogram;
+    CHECK_EQ(histogram.percentile(50), 0);   // Nothing recorded
+    for (uint32_t i = 0; i < 100; i++)
+        histogram.record(1000);               // Bucket 9, [512, 1023]
+    for (uint32_t i = 0; i < 5; i++)
+        histogram.record(50000);              // Bucket 15, [32768, 65535]
+    CHECK_EQ(histogram.count(), 105);
+    CHECK_EQ(histogram.max(), 50000);
+    CHECK_EQ(histogram.percentile(50), 1023);
+    CHECK_EQ(histogram.percentile(95), 1023);   // Rank 100 is the last sample of bucket 9
+    CHECK_EQ(histogram.percentile(96), 50000);  // Bucket 15, capped at the largest sample
+    CHECK_EQ(histogram.percentile(100), 50000);
+
+    LatencyHistogram small;
+    small.record(0);
+    small.record(1);
+    CHECK_EQ(small.percentile(100), 1);   // Bucket 0 holds 0 and 1
+    small.record(3);
+    CHECK_EQ(small.percentile(100), 3);
+
+    LatencyHistogram open_ended;
+    open_ended.record(0xFFFFFFFF);        // Last bucket is open ended and reports the maximum
+    CHECK_EQ(open_ended.percentile(50), 0xFFFFFFFF);
+}
+
+// Each publish window starts empty, a slow window is not averaged away by the hours before it
+static void test_window()
+{
+    LatencyHistogram histogram;
+    for (uint32_t i = 0; i < 10000; i++)
+        histogram.record(1000);
+    histogram.reset();
+    CHECK_EQ(histogram.count(), 0);
+    CHECK_EQ(histogram.max(), 0);
+    CHECK_EQ(histogram.percentile(95), 0);
+    for (uint32_t i = 0; i < 10; i++)
+        histogram.record(50000);
+    CHECK_EQ(histogram.count(), 10);
+    CHECK_EQ(histogram.percentile(95), 50000);
+}
+
+static void test_timed_frames()
+{
+    TimedDecoder decoder;
+    uint8_t presence = 0x01;
+    uint8_t frame[1 + seeed_radar::FRAME_OVERHEAD];
+    size_t len = seeed_radar::build_frame(frame, 0x80, 0x01, &presence, 1);
+    CHECK_EQ(len, 10);
+
+    for (int i = 0; i < 19; i++)
+    {
+        decoder.feed_timed(frame, len);
+        decoder.now_us += 500000;   // Idle line between reports
+    }
+    decoder.feed_timed(frame, len, 5, 40000);   // The UART drain stalled for 40 ms in the middle of a frame
+
+    // A corrupted frame is neither timed nor published
+    uint8_t corrupted[sizeof(frame)];
+    for (size_t i = 0; i < len; i++)
+        corrupted[i] = frame[i];
+    corrupted[len - 3] ^= 0xFF;
+    decoder.feed_timed(corrupted, len);
+    CHECK_EQ(decoder.errors, 1);
+
+    // Header byte to tail byte: 9 byte times, bucket 9
+    uint32_t receive_us = 9 * BYTE_US;
+    CHECK_EQ(decoder.receive.count(), 20);
+    CHECK_EQ(decoder.receive.percentile(50), 1023);
+    CHECK_EQ(decoder.receive.percentile(95), 1023);
+    CHECK_EQ(decoder.receive.max(), receive_us + 40000);
+    CHECK_EQ(decoder.receive.percentile(100), receive_us + 40000);
+
+    // Total adds the publish, the frame is dispatched as soon as its tail byte is read
+    CHECK_EQ(decoder.total.count(), 20);
+    CHECK_EQ(decoder.total.percentile(50), 1023);
+    CHECK_EQ(decoder.total.max(), receive_us + 40000 + decoder.publish_cost_us);
+}
+
+int main()
+{
+    test_buckets();
+    test_window();
+    test_timed_frames();
+    return test_result("test_latency_histogram");
+}
@@ -0,0 +1,101 @@
+// Calibration noise floor: mean, standard deviation and peak of the sampled energy, and the threshold
+// written from them with its margin and the ENERGY_MAX clamp
+#include "harness.h"
+#include "mr24hpc1/mr24hpc1.h"
+
+#include <cmath>
+#include <vector>
+
+using esphome::mr24hpc1::NoiseFloorEstimator;
+
+static NoiseFloorEstimator estimate(const std::vector<uint8_t> &samples)
+{
+    NoiseFloorEstimator noise;
+    for (uint8_t sample : samples)
+        noise.add(sample);
+    return noise;
+}
+
+// Against a two-pass reference over a long noisy trace
+static void test_statistics()
+{
+    std::vector<uint8_t> samples;
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        samples.push_back(30 + (seed >> 16) % 21);   // 30 to 50
+    }
+    double sum = 0.0;
+    for (uint8_t sample : samples)
+        sum += sample;
+    double mean = sum / samples.size();
+    double squares = 0.0;
+    for (uint8_t sample : samples)
+        squares += (sample - mean) * (sample - mean);
+    double stddev = sqrt(squares / (samples.size() - 1));
+
+    NoiseFloorEstimator noise = estimate(samples);
+    CHECK_EQ(noise.count(), samples.size());
+    CHECK_NEAR(noise.mean(), mean, 0.01);
+    CHECK_NEAR(noise.stddev(), stddev, 0.01);
+    CHECK_EQ(noise.max(), 50);
+
+    noise.reset();
+    CHECK_EQ(noise.count(), 0);
+    CHECK_EQ(noise.max(), 0);
+    CHECK_EQ(noise.stddev(), 0.0f);
+    CHECK_EQ(noise.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), 0);
+}
+
+static void test_threshold()
+{
+    // A steady floor: no spread, the peak decides, the margin goes on top
+    NoiseFloorEstimator steady = estimate(std::vector<uint8_t>(50, 20));
+    CHECK_EQ(steady.stddev(), 0.0f);
+    CHECK_EQ(steady.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), 20);
+    CHECK_EQ(steady.threshold(CALIBRATION_SIGMAS, 5, ENERGY_MAX), 25);
+
+    // A wide spread: mean + 3 sigma is above every sample, rounded up
+    std::vector<uint8_t> samples;
+    for (uint8_t i = 0; i < 50; i++)
+    {
+        samples.push_back(10);
+        samples.push_back(30);
+    }
+    NoiseFloorEstimator spread = estimate(samples);
+    CHECK_NEAR(spread.mean(), 20.0f, 0.001f);
+    CHECK_NEAR(spread.stddev(), 10.05f, 0.01f);
+    CHECK_EQ(spread.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), 51);
+    CHECK_EQ(spread.threshold(CALIBRATION_SIGMAS, 5, ENERGY_MAX), 56);
+
+    // One spike: 3 sigma stays below it, the threshold still clears the peak
+    samples.assign(99, 20);
+    samples.push_back(90);
+    NoiseFloorEstimator spike = estimate(samples);
+    CHECK(spike.mean() + CALIBRATION_SIGMAS * spike.stddev() < 90.0f);
+    CHECK_EQ(spike.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), 90);
+    CHECK_EQ(spike.threshold(CALIBRATION_SIGMAS, 5, ENERGY_MAX), 95);
+}
+
+// The radar takes thresholds up to ENERGY_MAX, a noisier room gets the highest one
+static void test_clamp()
+{
+    NoiseFloorEstimator high = estimate(std::vector<uint8_t>(50, 248));
+    CHECK_EQ(high.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), 248);
+    CHECK_EQ(high.threshold(CALIBRATION_SIGMAS, 2, ENERGY_MAX), ENERGY_MAX);
+    CHECK_EQ(high.threshold(CALIBRATION_SIGMAS, 5, ENERGY_MAX), ENERGY_MAX);
+    CHECK_EQ(high.threshold(CALIBRATION_SIGMAS, 100, ENERGY_MAX), ENERGY_MAX);   // No uint8_t wrap
+
+    NoiseFloorEstimator saturated = estimate({180, 255, 200, 255, 190});
+    CHECK_EQ(saturated.max(), 255);
+    CHECK_EQ(saturated.threshold(CALIBRATION_SIGMAS, 0, ENERGY_MAX), ENERGY_MAX);
+}
+
+int main()
+{
+    test_statistics();
+    test_threshold();
+    test_clamp();
+    return test_result("test_noise_floor");
+}
@@ -0,0 +1,95 @@
+// Fused presence: the stream thresholds with their hold time, and the radar presence report holding
+// the room while no stream frames arrive
+#include "harness.h"
+#include "host_radar.h"
+
+using namespace esphome;
+using namespace esphome::host;
+using esphome::mr24hpc1::PresenceFusion;
+using esphome::mr24hpc1::UnderlyingOpenFrame;
+
+static UnderlyingOpenFrame quiet_frame() { return UnderlyingOpenFrame{}; }
+
+static UnderlyingOpenFrame moving_frame()
+{
+    UnderlyingOpenFrame frame{};
+    frame.motion_energy = 60;
+    frame.motion_distance = 4;
+    return frame;
+}
+
+static void test_stream_hold()
+{
+    PresenceFusion fusion;
+    CHECK(!fusion.feed(quiet_frame(), 0));
+    CHECK(fusion.feed(moving_frame(), 100));
+    CHECK(fusion.is_present());
+    CHECK(!fusion.feed(quiet_frame(), 4000));   // Held
+    CHECK_EQ(fusion.hold_remaining(4000), 1100);
+    CHECK(fusion.feed(quiet_frame(), 5100));    // Released after the hold time
+    CHECK(!fusion.is_present());
+}
+
+// The radar reports presence once. Without a stream nothing else arrives, the room stays occupied.
+static void test_radar_hold()
+{
+    PresenceFusion fusion;
+    CHECK(fusion.feed_radar_presence(true, 0));
+    for (uint32_t now = 0; now <= 600000; now += 5000)
+        CHECK(!fusion.expire(now));
+    CHECK(fusion.is_present());
+    CHECK(!fusion.feed_radar_presence(false, 601000));   // Still the hold time after the last evidence
+    CHECK(fusion.expire(606000));
+    CHECK(!fusion.is_present());
+}
+
+// With the stream running the frames decide, the radar report only brings the arrival forward
+static void test_stream_decides()
+{
+    PresenceFusion fusion;
+    CHECK(fusion.feed_radar_presence(true, 0));
+    uint32_t now = 0;
+    for (; now < 5000; now += 500)
+        CHECK(!fusion.feed(quiet_frame(), now));
+    CHECK(fusion.feed(quiet_frame(), now));
+    CHECK(!fusion.is_present());
+
+    // The stream stops while the radar still reports someone: the report holds again
+    CHECK(fusion.feed(moving_frame(), 10000));
+    CHECK(!fusion.expire(15000));
+    CHECK(!fusion.expire(60000));
+    CHECK(fusion.is_present());
+}
+
+// The default manual mode has the stream off: a person sitting still stays present
+static void test_component_without_stream()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    instance.radar.set_fused_presence_binary_sensor(&instance.entities.fused_presence);
+    instance.radar.configure_presence_fusion(20, 40, 5, 5, 0, 5000);
+    scenario.start();
+
+    instance.simulated.report_presence(true);
+    g_core.run(200);
+    CHECK(instance.entities.fused_presence.state);
+    g_core.reset_stats();
+    g_core.run(120000);
+    CHECK(instance.entities.fused_presence.state);
+    CHECK(g_core.stats().loops < 120000 / HOST_LOOP_INTERVAL_MS / 4);   // Held by a timer, loop() sleeps
+
+    instance.simulated.report_presence(false);
+    g_core.run(4000);
+    CHECK(instance.entities.fused_presence.state);
+    g_core.run(1500);
+    CHECK(!instance.entities.fused_presence.state);
+}
+
+int main()
+{
+    test_stream_hold();
+    test_radar_hold();
+    test_stream_decides();
+    test_component_without_stream();
+    return test_result("test_presence_fusion");
+}
@@ -0,0 +1,207 @@
+// Room aggregate: the presence vote and telemetry of several radars reporting on independent schedules,
+// with silent radars dropping out after the stale timeout
+#include "harness.h"
+#include "mr24hpc1_aggregator/room_aggregate.h"
+
+#include <vector>
+
+using namespace esphome::mr24hpc1_aggregator;
+
+// One radar: heartbeat replies and underlying open frames on its own period and phase
+struct SimRadar
+{
+    uint32_t heartbeat_ms;
+    uint32_t frame_ms;   // 0 = underlying open stream off
+    uint32_t phase_ms;
+    bool alive{true};
+    bool present{false};
+    uint8_t distance{0};
+    uint8_t motion_energy{0};
+};
+
+struct Simulation
+{
+    RoomAggregate room;
+    std::vector<SimRadar> radars;
+    uint32_t now{0};
+
+    Simulation(AggregatorMode mode, uint32_t start = 0) : now(start)
+    {
+        this->room.set_mode(mode);
+        this->room.set_quorum(2);
+        this->room.set_stale_timeout(10000);
+    }
+
+    size_t add(uint32_t heartbeat_ms, uint32_t frame_ms, uint32_t phase_ms)
+    {
+        this->radars.push_back(SimRadar{heartbeat_ms, frame_ms, phase_ms});
+        return this->room.add_radar();
+    }
+
+    // A presence change is reported by that radar right away, like the 0x80/0x01 report
+    void set_presence(size_t index, bool present)
+    {
+        this->radars[index].present = present;
+        if (this->radars[index].alive)
+            this->room.set_presence(index, present, this->now);
+    }
+
+    void run(uint32_t duration_ms)
+    {
+        for (uint32_t step = 0; step < duration_ms; step += 100)
+        {
+            this->now += 100;
+            for (size_t i = 0; i < this->radars.size(); i++)
+            {
+                const SimRadar &radar = this->radars[i];
+                if (!radar.alive)
+                    continue;
+                uint32_t t = this->now - radar.phase_ms;
+                if (t % radar.heartbeat_ms == 0)
+                    this->room.seen(i, this->now);
+                if (radar.frame_ms != 0 && t % radar.frame_ms == 0)
+                    this->room.set_frame(i, radar.distance, radar.motion_energy, this->now);
+            }
+        }
+    }
+};
+
+static void test_modes()
+{
+    for (AggregatorMode mode : {AGGREGATOR_MODE_ANY, AGGREGATOR_MODE_QUORUM, AGGREGATOR_MODE_ALL})
+    {
+        Simulation sim(mode);
+        sim.add(8000, 1000, 300);
+        sim.add(8000, 700, 4100);
+        sim.add(5000, 0, 2500);
+        sim.run(3000);
+        CHECK(!sim.room.occupied(sim.now));
+
+        sim.set_presence(0, true);   // Walks in next to radar 0
+        CHECK_EQ(sim.room.occupied(sim.now), mode == AGGREGATOR_MODE_ANY);
+        sim.run(1500);
+        sim.set_presence(1, true);
+        CHECK_EQ(sim.room.occupied(sim.now), mode != AGGREGATOR_MODE_ALL);
+        sim.run(2200);
+        sim.set_presence(2, true);
+        CHECK(sim.room.occupied(sim.now));
+        sim.run(60000);               // Nothing changes while every radar keeps answering
+        CHECK(sim.room.occupied(sim.now));
+
+        sim.set_presence(0, false);
+        CHECK_EQ(sim.room.occupied(sim.now), mode != AGGREGATOR_MODE_ALL);
+        sim.set_presence(1, false);
+        CHECK_EQ(sim.room.occupied(sim.now), mode == AGGREGATOR_MODE_ANY);
+        sim.set_presence(2, false);
+        CHECK(!sim.room.occupied(sim.now));
+    }
+}
+
+// A radar that goes silent while reporting presence must not hold the room occupied
+static void test_silent_radar()
+{
+    Simulation sim(AGGREGATOR_MODE_ANY);
+    sim.add(8000, 0, 0);
+    sim.add(8000, 0, 3000);
+    sim.run(2000);
+    sim.set_presence(1, true);
+    sim.run(5000);
+    sim.radars[1].alive = false;   // UART unplugged, the last report was "present"
+    uint32_t silent_since = sim.now;
+    sim.run(5000);
+    CHECK(sim.room.occupied(sim.now));
+    sim.run(20000);
+    CHECK(!sim.room.occupied(sim.now));
+    CHECK(sim.now - silent_since <= 30000);
+
+    // In AGGREGATOR_MODE_ALL the silent radar no longer blocks the vote of the others
+    Simulation all(AGGREGATOR_MODE_ALL);
+    all.add(8000, 0, 0);
+    all.add(8000, 0, 1000);
+    all.run(2000);
+    all.radars[1].alive = false;
+    all.set_presence(0, true);
+    CHECK(!all.room.occupied(all.now));
+    all.run(20000);
+    CHECK(all.room.occupied(all.now));
+
+    // It votes again once it is back
+    all.radars[1].alive = true;
+    all.run(8000);
+    CHECK(!all.room.occupied(all.now));
+}
+
+static void test_telemetry()
+{
+    Simulation sim(AGGREGATOR_MODE_ANY);
+    sim.add(8000, 1000, 0);
+    sim.add(8000, 700, 300);
+    sim.add(8000, 0, 0);   // Stream off, never contributes telemetry
+    sim.radars[0].distance = 8;
+    sim.radars[0].motion_energy = 30;
+    sim.radars[1].distance = 5;
+    sim.radars[1].motion_energy = 12;
+    sim.radars[2].distance = 1;
+    sim.run(3000);
+    CHECK_EQ(sim.room.nearest_distance(sim.now), 5);
+    CHECK_EQ(sim.room.motion_energy(sim.now), 30);
+
+    sim.radars[1].distance = 0;   // Target left radar 1's field of view
+    sim.run(1000);
+    CHECK_EQ(sim.room.nearest_distance(sim.now), 8);
+
+    sim.radars[1].distance = 3;
+    sim.run(1000);
+    sim.radars[0].alive = false;   // Its energy is dropped once its stream is stale
+    sim.run(9000);
+    CHECK_EQ(sim.room.motion_energy(sim.now), 30);
+    sim.run(2000);
+    CHECK_EQ(sim.room.nearest_distance(sim.now), 3);
+    CHECK_EQ(sim.room.motion_energy(sim.now), 12);
+
+    sim.radars[1].alive = false;
+    sim.run(11000);
+    CHECK_EQ(sim.room.nearest_distance(sim.now), 0);
+    CHECK_EQ(sim.room.motion_energy(sim.now), 0);
+}
+
+// millis() wraps after 49.7 days
+static void test_millis_wrap()
+{
+    Simulation sim(AGGREGATOR_MODE_ANY, 0xFFFFFFFF - 3050);
+    sim.add(1000, 0, 0);
+    sim.set_presence(0, true);
+    sim.run(6000);
+    CHECK(sim.now < 10000);
+    CHECK(sim.room.occupied(sim.now));
+    sim.radars[0].alive = false;
+    sim.run(10500);
+    CHECK(!sim.room.occupied(sim.now));
+}
+
+// A quiet radar only answers the heartbeat once per 8 s update interval, the default stale timeout
+// keeps a present radar in the vote across a lost reply
+static void test_lost_heartbeat()
+{
+    RoomAggregate room;
+    size_t radar = room.add_radar();
+    room.add_radar();
+    room.set_presence(radar, true, 1000);
+    room.seen(radar, 9000);
+    // The reply at 17 s is lost, the next one arrives at 25 s
+    for (uint32_t now = 9000; now < 25000; now += 100)
+        CHECK(room.occupied(now));
+    room.seen(radar, 25000);
+    CHECK(room.occupied(50000));
+    CHECK(!room.occupied(55100));   // Silent for longer than the stale timeout
+}
+
+int main()
+{
+    test_modes();
+    test_silent_radar();
+    test_telemetry();
+    test_millis_wrap();
+    test_lost_heartbeat();
+    return test_result("test_room_aggregate");
+}
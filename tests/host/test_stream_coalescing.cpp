@@ -0,0 +1,58 @@
+// Stream report coalescing: a backlog of reports is published once per command, but every
+// report still reaches the frame consumers, and query replies are never coalesced
+#include "harness.h"
+#include "host_radar.h"
+
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::host;
+using esphome::mr24hpc1::UnderlyingOpenFrame;
+
+#define BACKLOG 10
+
+static void test_backlog()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    std::vector<UnderlyingOpenFrame> consumed;
+    instance.radar.add_on_underlying_open_callback([&](const UnderlyingOpenFrame &frame) { consumed.push_back(frame); });
+    scenario.start();
+
+    // A backlog that one loop() drains: reports interleaved with movement signs
+    consumed.clear();
+    uint32_t static_publishes = instance.entities.static_energy.publishes;
+    uint32_t signs_publishes = instance.entities.movement_signs.publishes;
+    for (uint8_t i = 0; i < BACKLOG; i++)
+    {
+        instance.simulated.report_underlying(100 + i, 4, 50 + i, 4, 10);
+        instance.simulated.send(0x08, 0x07, 20 + i);
+    }
+    g_core.run(100);
+
+    CHECK_EQ(consumed.size(), 2 * BACKLOG);   // Every report reached the consumers
+    for (uint8_t i = 0; i < BACKLOG; i++)
+    {
+        CHECK_EQ(consumed[2 * i].static_energy, 100 + i);
+        CHECK_EQ(consumed[2 * i].motion_energy, 50 + i);
+        CHECK_EQ(consumed[2 * i + 1].movement_signs, 20 + i);
+    }
+    CHECK_EQ(instance.entities.static_energy.publishes - static_publishes, 1);   // Only the newest was published
+    CHECK_EQ(instance.entities.static_energy.state, 100 + BACKLOG - 1);
+    CHECK_EQ(instance.entities.movement_signs.publishes - signs_publishes, 1);
+    CHECK_EQ(instance.entities.movement_signs.state, 20 + BACKLOG - 1);
+
+    // Query replies answer requests, each one is published
+    static_publishes = instance.entities.static_energy.publishes;
+    instance.simulated.send(0x08, 0x81, 30);
+    instance.simulated.send(0x08, 0x81, 31);
+    g_core.run(100);
+    CHECK_EQ(instance.entities.static_energy.publishes - static_publishes, 2);
+    CHECK_EQ(instance.entities.static_energy.state, 31);
+}
+
+int main()
+{
+    test_backlog();
+    return test_result("test_stream_coalescing");
+}
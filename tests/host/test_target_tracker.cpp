@@ -0,0 +1,124 @@
+// Moving target tracker: synthetic walks through the 0.5 m / 0.5 m/s quantization of the stream, and
+// the tracked sensors of the component going unknown once the stream stops
+#include "harness.h"
+#include "host_radar.h"
+#include "mr24hpc1/target_tracker.h"
+
+#include <cmath>
+
+using namespace esphome;
+using namespace esphome::host;
+using esphome::mr24hpc1::TargetTracker;
+
+// Walk at a constant velocity and report every period_ms like the underlying open stream does,
+// distance rounded to 0.5 m steps, speed truncated to 0.5 m/s steps around the raw value 10
+static TargetTracker walk(int32_t start_mm, int32_t velocity_mm_s, uint32_t duration_ms, uint32_t period_ms = 500)
+{
+    TargetTracker tracker;
+    tracker.set_alpha(128);
+    tracker.set_beta(26);
+    for (uint32_t t = 0; t <= duration_ms; t += period_ms)
+    {
+        double distance_mm = start_mm + (double) velocity_mm_s * t / 1000.0;
+        uint8_t raw_distance = (uint8_t) std::lround(distance_mm / 500.0);
+        uint8_t raw_speed = (uint8_t) (10 + velocity_mm_s / 500);
+        tracker.feed(raw_distance, raw_speed, 1000 + t);
+    }
+    return tracker;
+}
+
+static void test_slow_walker()
+{
+    // -250 mm/s rounds to a speed byte of 10 (0 m/s), which must not drag the estimate towards 0
+    TargetTracker tracker = walk(6000, -250, 16000);
+    CHECK(tracker.is_tracking());
+    CHECK_NEAR(tracker.velocity_mm_s(), -250, 60);
+    CHECK_NEAR(tracker.distance_mm(), 2000, 400);
+    CHECK(tracker.arrival_ms() > 0);
+}
+
+static void test_walks()
+{
+    TargetTracker approaching = walk(8000, -1000, 5000);
+    CHECK_NEAR(approaching.velocity_mm_s(), -1000, 150);
+    CHECK_NEAR(approaching.arrival_ms(), 3000, 600);
+
+    TargetTracker leaving = walk(1000, 600, 8000);
+    CHECK_NEAR(leaving.velocity_mm_s(), 600, 120);
+    CHECK_EQ(leaving.arrival_ms(), -1);
+
+    TargetTracker standing = walk(3000, 0, 10000);
+    CHECK_NEAR(standing.velocity_mm_s(), 0, 30);
+    CHECK_EQ(standing.arrival_ms(), -1);
+}
+
+static void test_lost_target()
+{
+    TargetTracker tracker;
+    CHECK(tracker.feed(6, 10, 1000));
+    CHECK(!tracker.feed(0, 10, 1500));   // No moving target reported
+    CHECK(!tracker.is_tracking());
+    CHECK(tracker.feed(4, 10, 2000));    // A new target starts at rest
+    CHECK_EQ(tracker.distance_mm(), 2000);
+    CHECK_EQ(tracker.velocity_mm_s(), 0);
+}
+
+// A target approaching the radar at 1 m/s, one report per second
+static void walk_in(Instance &instance)
+{
+    for (uint8_t distance = 10; distance > 4; distance--)
+    {
+        instance.simulated.report_underlying(0, 0, 60, distance, 8);
+        g_core.run(1000);
+    }
+}
+
+static void test_component()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    sensor::Sensor distance, velocity, arrival;
+    instance.radar.set_tracked_distance_sensor(&distance);
+    instance.radar.set_tracked_velocity_sensor(&velocity);
+    instance.radar.set_arrival_time_sensor(&arrival);
+    instance.radar.configure_target_tracker(128, 26);
+    scenario.start();
+    instance.simulated.send(0x08, 0x00, 0x01);   // Stream on
+
+    // The reports stop: the target is dropped TRACKER_LOST_MS after the last one
+    walk_in(instance);
+    CHECK(!std::isnan(distance.state));
+    CHECK(velocity.state < 0.0f);
+    CHECK(!std::isnan(arrival.state));
+    g_core.run(TRACKER_LOST_MS - 1000 - 100);
+    CHECK(!std::isnan(distance.state));
+    g_core.run(200);
+    CHECK(std::isnan(distance.state));
+    CHECK(std::isnan(velocity.state));
+    CHECK(std::isnan(arrival.state));
+
+    // The stream is switched off: dropped right away
+    walk_in(instance);
+    CHECK(!std::isnan(distance.state));
+    instance.simulated.send(0x08, 0x00, 0x00);
+    g_core.run(100);
+    CHECK(std::isnan(distance.state));
+    CHECK(std::isnan(velocity.state));
+    CHECK(std::isnan(arrival.state));
+
+    // and a new walk starts a new track at rest
+    instance.simulated.send(0x08, 0x00, 0x01);
+    instance.simulated.report_underlying(0, 0, 60, 6, 8);
+    g_core.run(100);
+    CHECK_NEAR(distance.state, 3.0f, 0.01f);
+    CHECK_EQ(velocity.state, 0.0f);
+}
+
+int main()
+{
+    test_slow_walker();
+    test_walks();
+    test_lost_target();
+    test_component();
+    return test_result("test_target_tracker");
+}
@@ -0,0 +1,47 @@
+// Distance zones: every zone starts unoccupied, a distance frame enters and leaves them through the
+// lookup tables the code generation builds
+#include "harness.h"
+#include "host_radar.h"
+
+using namespace esphome;
+using namespace esphome::host;
+
+// Zone 0 is [1 m, 2 m] and zone 1 [2.5 m, 3 m], both with 0.5 m hysteresis, in 0.5 m radar steps
+static const uint32_t ZONE_ENTER[8] = {0, 0, 1, 1, 1, 2, 2, 0};
+static const uint32_t ZONE_STAY[8] = {0, 1, 1, 1, 3, 3, 2, 2};
+
+static void test_zones()
+{
+    Scenario scenario;
+    Instance &instance = scenario.instance;
+    binary_sensor::BinarySensor near, far;
+    instance.radar.set_zone_lookup(ZONE_ENTER, ZONE_STAY, 8);
+    instance.radar.add_zone_binary_sensor(&near);
+    instance.radar.add_zone_binary_sensor(&far);
+    scenario.start();
+
+    // The stream is off, nothing reported a distance yet
+    CHECK(near.has_state());
+    CHECK(far.has_state());
+    CHECK(!near.state);
+    CHECK(!far.state);
+
+    instance.simulated.report_underlying(0, 0, 60, 3, 10);   // 1.5 m
+    g_core.run(100);
+    CHECK(near.state);
+    CHECK(!far.state);
+    instance.simulated.report_underlying(0, 0, 60, 4, 10);   // 2 m, still zone 0
+    g_core.run(100);
+    CHECK(near.state);
+    CHECK(!far.state);
+    instance.simulated.report_underlying(0, 0, 60, 6, 10);   // 3 m
+    g_core.run(100);
+    CHECK(!near.state);
+    CHECK(far.state);
+}
+
+int main()
+{
+    test_zones();
+    return test_result("test_zones");
+}